@@ -1,20 +1,56 @@
+// mmap/open/fstat fazem parte do POSIX, não do C99
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "bplus.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
-// Estrutura básica para nó da B+ Tree
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Lista de valores de uma chave: valores ordenados e sem repetição, gravados
+// como o primeiro valor (zigzag) seguido das diferenças, todos em varint
+typedef struct {
+    unsigned char *data;
+    int size;       // Bytes usados
+    int capacity;   // Bytes alocados
+    int count;      // Quantidade de valores
+    long last;      // Maior valor (permite anexar sem decodificar)
+} BPlusPostings;
+
+// Leitor sequencial de uma lista codificada (em memória ou no arquivo mapeado)
+typedef struct {
+    const unsigned char *data;
+    const unsigned char *end;
+    int remaining;
+    long current;
+    bool started;
+} BPlusPostingsCursor;
+
+// Estrutura básica para nó da B+ Tree. O nó inteiro (cabeçalho, chaves e
+// listas ou filhos) ocupa um único bloco alinhado a linhas de cache; os
+// ponteiros abaixo apontam para dentro desse bloco. Os vetores têm uma
+// posição extra para o nó poder transbordar por uma chave antes de ser dividido.
 typedef struct BPlusNode {
-    int *keys;
-    long *values;
-    struct BPlusNode **children;
     int num_keys;
     int is_leaf;
+    BPlusKey *keys;
+    BPlusPostings *postings;      // Folhas: lista de valores de cada chave
+    struct BPlusNode **children;  // Nós internos
     struct BPlusNode *next; // Para folhas
-    struct BPlusNode *parent; // Adicionar referência ao pai
+    int page_id;            // Página do nó no arquivo (usado ao salvar)
 } BPlusNode;
 
+#define BPLUS_CACHE_LINE 64
+
 // Estrutura da B+ Tree
 struct BPlusTree {
     BPlusNode *root;
@@ -22,29 +58,359 @@ struct BPlusTree {
     int order;
     int node_count; // Contar nós para estatísticas
     int height;     // Altura da árvore
+    int key_count;  // Chaves distintas
+    int value_count; // Valores em todas as listas
+
+    // Modo somente leitura sobre o arquivo mapeado (map == NULL em memória)
+    const unsigned char *map;
+    size_t map_size;
+    int page_size;
+    int page_count;
+    int root_page;
 };
 
 // Declarações das funções internas
 void bplus_destroy_node(BPlusNode *node);
 BPlusNode* bplus_create_node(int order, int is_leaf);
-BPlusNode* bplus_split_node(BPlusTree *tree, BPlusNode *node);
-void bplus_collect_range_values(BPlusNode *node, int min_key, int max_key, long **results, int *count, int *capacity);
-BPlusNode* bplus_find_leaf_for_key(BPlusTree *tree, int key);
+BPlusNode* bplus_find_leaf_for_key(BPlusTree *tree, BPlusKey key);
+static void bplus_unmap_file(BPlusTree *tree);
+static long* bplus_mapped_search(BPlusTree *tree, BPlusKey key, int *count);
+static long* bplus_mapped_search_range(BPlusTree *tree, BPlusKey min_key, BPlusKey max_key, int *count);
+
+// =============================================================================
+// LISTAS DE VALORES (POSTINGS)
+// =============================================================================
+
+static int bplus_varint_size(unsigned long long value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static int bplus_varint_write(unsigned char *out, unsigned long long value) {
+    int size = 0;
+    while (value >= 0x80) {
+        out[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (unsigned char)value;
+    return size;
+}
+
+// Lê um varint; retorna NULL se os bytes acabarem antes do fim do número
+static const unsigned char* bplus_varint_read(const unsigned char *in, const unsigned char *end,
+                                              unsigned long long *value) {
+    unsigned long long result = 0;
+    int shift = 0;
+    while (in < end && shift < 64) {
+        unsigned char byte = *in++;
+        result |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return in;
+        }
+        shift += 7;
+    }
+    return NULL;
+}
+
+static unsigned long long bplus_zigzag_encode(long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value < 0 ? -1LL : 0);
+}
+
+static long bplus_zigzag_decode(unsigned long long value) {
+    return (long)(value >> 1) ^ -(long)(value & 1);
+}
+
+static void bplus_postings_init(BPlusPostings *postings) {
+    postings->data = NULL;
+    postings->size = 0;
+    postings->capacity = 0;
+    postings->count = 0;
+    postings->last = 0;
+}
+
+static void bplus_postings_free(BPlusPostings *postings) {
+    free(postings->data);
+    bplus_postings_init(postings);
+}
+
+static bool bplus_postings_reserve(BPlusPostings *postings, int extra) {
+    if (postings->size + extra <= postings->capacity) return true;
+
+    int new_capacity = postings->capacity > 0 ? postings->capacity * 2 : 8;
+    while (new_capacity < postings->size + extra) {
+        new_capacity *= 2;
+    }
+    unsigned char *new_data = realloc(postings->data, new_capacity);
+    if (!new_data) return false;
+
+    postings->data = new_data;
+    postings->capacity = new_capacity;
+    return true;
+}
+
+static void bplus_cursor_init(BPlusPostingsCursor *cursor, const unsigned char *data, int size, int count) {
+    cursor->data = data;
+    cursor->end = data + size;
+    cursor->remaining = count;
+    cursor->current = 0;
+    cursor->started = false;
+}
+
+// Avança para o próximo valor; retorna false no fim da lista
+static bool bplus_cursor_next(BPlusPostingsCursor *cursor) {
+    if (cursor->remaining <= 0) return false;
+
+    unsigned long long raw;
+    const unsigned char *next = bplus_varint_read(cursor->data, cursor->end, &raw);
+    if (!next) {
+        cursor->remaining = 0;
+        return false;
+    }
+    cursor->data = next;
+    cursor->current = cursor->started ? cursor->current + (long)raw : bplus_zigzag_decode(raw);
+    cursor->started = true;
+    cursor->remaining--;
+    return true;
+}
+
+// Decodifica a lista inteira para um vetor (count posições)
+static int bplus_postings_decode(const unsigned char *data, int size, int count, long *out) {
+    BPlusPostingsCursor cursor;
+    bplus_cursor_init(&cursor, data, size, count);
+    int decoded = 0;
+    while (bplus_cursor_next(&cursor)) {
+        out[decoded++] = cursor.current;
+    }
+    return decoded;
+}
+
+// Recodifica a lista a partir de um vetor ordenado sem repetições
+static bool bplus_postings_encode(BPlusPostings *postings, const long *values, int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+        size += bplus_varint_size(i == 0 ? bplus_zigzag_encode(values[0])
+                                         : (unsigned long long)(values[i] - values[i - 1]));
+    }
+
+    unsigned char *data = malloc(size > 0 ? size : 1);
+    if (!data) return false;
+
+    int offset = 0;
+    for (int i = 0; i < count; i++) {
+        offset += bplus_varint_write(data + offset, i == 0 ? bplus_zigzag_encode(values[0])
+                                                           : (unsigned long long)(values[i] - values[i - 1]));
+    }
+
+    free(postings->data);
+    postings->data = data;
+    postings->size = size;
+    postings->capacity = size > 0 ? size : 1;
+    postings->count = count;
+    postings->last = count > 0 ? values[count - 1] : 0;
+    return true;
+}
+
+// Adiciona um valor à lista. Retorna 1 se foi adicionado, 0 se já existia
+// e -1 em caso de erro de memória.
+static int bplus_postings_add(BPlusPostings *postings, long value) {
+    // Caminho comum: valores chegam em ordem crescente e são apenas anexados
+    if (postings->count == 0 || value > postings->last) {
+        unsigned long long raw = postings->count == 0 ? bplus_zigzag_encode(value)
+                                                      : (unsigned long long)(value - postings->last);
+        if (!bplus_postings_reserve(postings, bplus_varint_size(raw))) return -1;
+
+        postings->size += bplus_varint_write(postings->data + postings->size, raw);
+        postings->count++;
+        postings->last = value;
+        return 1;
+    }
+    if (value == postings->last) return 0;
+
+    // Valor fora de ordem: decodifica, insere na posição e recodifica
+    long *values = malloc((postings->count + 1) * sizeof(long));
+    if (!values) return -1;
+    int count = bplus_postings_decode(postings->data, postings->size, postings->count, values);
+
+    int pos = 0;
+    while (pos < count && values[pos] < value) {
+        pos++;
+    }
+    if (pos < count && values[pos] == value) {
+        free(values);
+        return 0;
+    }
+    memmove(&values[pos + 1], &values[pos], (count - pos) * sizeof(long));
+    values[pos] = value;
+
+    bool ok = bplus_postings_encode(postings, values, count + 1);
+    free(values);
+    return ok ? 1 : -1;
+}
+
+// Calcula o maior valor de uma lista carregada do disco
+static void bplus_postings_refresh_last(BPlusPostings *postings) {
+    BPlusPostingsCursor cursor;
+    bplus_cursor_init(&cursor, postings->data, postings->size, postings->count);
+    postings->last = 0;
+    while (bplus_cursor_next(&cursor)) {
+        postings->last = cursor.current;
+    }
+}
+
+// Reposiciona heap[pos] no heap mínimo ordenado pelo valor atual de cada cursor
+static void bplus_heap_sift_down(int *heap, int heap_size, const BPlusPostingsCursor *cursors, int pos) {
+    while (true) {
+        int smallest = pos, left = 2 * pos + 1, right = 2 * pos + 2;
+        if (left < heap_size && cursors[heap[left]].current < cursors[heap[smallest]].current) smallest = left;
+        if (right < heap_size && cursors[heap[right]].current < cursors[heap[smallest]].current) smallest = right;
+        if (smallest == pos) return;
+
+        int tmp = heap[pos];
+        heap[pos] = heap[smallest];
+        heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+// Intercala várias listas ordenadas em um único vetor crescente. Com uma só
+// lista os valores são apenas decodificados; com várias usa um heap mínimo.
+static long* bplus_merge_postings(BPlusPostingsCursor *cursors, int list_count, int total, int *count) {
+    *count = 0;
+    if (list_count == 0 || total <= 0) return NULL;
+
+    long *results = malloc(total * sizeof(long));
+    if (!results) return NULL;
+
+    if (list_count == 1) {
+        while (*count < total && bplus_cursor_next(&cursors[0])) {
+            results[(*count)++] = cursors[0].current;
+        }
+    } else {
+        int *heap = malloc(list_count * sizeof(int));
+        if (!heap) {
+            free(results);
+            return NULL;
+        }
+
+        int heap_size = 0;
+        for (int i = 0; i < list_count; i++) {
+            if (bplus_cursor_next(&cursors[i])) heap[heap_size++] = i;
+        }
+
+        for (int pos = heap_size / 2 - 1; pos >= 0; pos--) {
+            bplus_heap_sift_down(heap, heap_size, cursors, pos);
+        }
+
+        // Retira o menor valor atual e avança a lista de onde ele veio
+        while (heap_size > 0 && *count < total) {
+            BPlusPostingsCursor *top = &cursors[heap[0]];
+            results[(*count)++] = top->current;
+
+            if (!bplus_cursor_next(top)) {
+                heap[0] = heap[--heap_size];
+            }
+            bplus_heap_sift_down(heap, heap_size, cursors, 0);
+        }
+        free(heap);
+    }
+
+    if (*count == 0) {
+        free(results);
+        return NULL;
+    }
+    return results;
+}
+
+// Vetor de cursores que cresce conforme as chaves do intervalo são visitadas
+typedef struct {
+    BPlusPostingsCursor *items;
+    int count;
+    int capacity;
+    int total_values;
+} BPlusCursorList;
+
+static bool bplus_cursor_list_add(BPlusCursorList *list, const unsigned char *data, int size, int count) {
+    if (list->count >= list->capacity) {
+        int new_capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        BPlusPostingsCursor *new_items = realloc(list->items, new_capacity * sizeof(BPlusPostingsCursor));
+        if (!new_items) return false;
+        list->items = new_items;
+        list->capacity = new_capacity;
+    }
+    bplus_cursor_init(&list->items[list->count++], data, size, count);
+    list->total_values += count;
+    return true;
+}
+
+// =============================================================================
+// CRIAÇÃO E DESTRUIÇÃO
+// =============================================================================
 
 BPlusTree* bplus_create(const char *filename) {
+    return bplus_create_with_order(filename, BPLUS_DEFAULT_ORDER);
+}
+
+BPlusTree* bplus_create_with_order(const char *filename, int order) {
+    if (order < BPLUS_MIN_ORDER || order > BPLUS_MAX_ORDER) return NULL;
+
     BPlusTree *tree = malloc(sizeof(BPlusTree));
     if (!tree) return NULL;
 
     tree->root = NULL;
-    tree->order = 4; // Ordem padrão
+    tree->order = order;
     tree->node_count = 0;
     tree->height = 0;
+    tree->key_count = 0;
+    tree->value_count = 0;
+    tree->map = NULL;
+    tree->map_size = 0;
+    tree->page_size = 0;
+    tree->page_count = 0;
+    tree->root_page = 0;
     strncpy(tree->filename, filename ? filename : "bplus.dat", sizeof(tree->filename) - 1);
     tree->filename[sizeof(tree->filename) - 1] = '\0';
 
     return tree;
 }
 
+int bplus_get_order(const BPlusTree *tree) {
+    return tree ? tree->order : 0;
+}
+
+// Blocos de nó alinhados ao início de uma linha de cache
+static void* bplus_alloc_block(size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, BPLUS_CACHE_LINE);
+#else
+    void *block = NULL;
+    return posix_memalign(&block, BPLUS_CACHE_LINE, size) == 0 ? block : NULL;
+#endif
+}
+
+static void bplus_free_block(void *block) {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+// Libera apenas o próprio nó, sem descer para os filhos
+static void bplus_free_node_shallow(BPlusNode *node) {
+    if (!node) return;
+    if (node->postings) {
+        for (int i = 0; i < node->num_keys; i++) {
+            bplus_postings_free(&node->postings[i]);
+        }
+    }
+    bplus_free_block(node);
+}
+
 void bplus_destroy_node(BPlusNode *node) {
     if (!node) return;
 
@@ -52,445 +418,1022 @@ void bplus_destroy_node(BPlusNode *node) {
         for (int i = 0; i <= node->num_keys; i++) {
             bplus_destroy_node(node->children[i]);
         }
-        free(node->children);
     }
 
-    free(node->keys);
-    free(node->values);
-    free(node);
+    bplus_free_node_shallow(node);
 }
 
 void bplus_destroy(BPlusTree *tree) {
     if (!tree) return;
 
+    bplus_unmap_file(tree);
     bplus_destroy_node(tree->root);
     free(tree);
 }
 
+// Layout do bloco: BPlusNode | BPlusKey keys[order] | listas[order] ou filhos[order + 1].
+// As chaves vêm logo após o cabeçalho, então a busca dentro do nó percorre
+// linhas de cache consecutivas.
 BPlusNode* bplus_create_node(int order, int is_leaf) {
-    BPlusNode *node = malloc(sizeof(BPlusNode));
-    if (!node) return NULL;
+    size_t keys_offset = sizeof(BPlusNode);
+    size_t payload_offset = keys_offset + order * sizeof(BPlusKey);
+    payload_offset = (payload_offset + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    size_t size = payload_offset + (is_leaf ? order * sizeof(BPlusPostings)
+                                            : (order + 1) * sizeof(BPlusNode*));
+    size = (size + BPLUS_CACHE_LINE - 1) & ~(size_t)(BPLUS_CACHE_LINE - 1);
+
+    unsigned char *block = bplus_alloc_block(size);
+    if (!block) return NULL;
 
-    node->keys = malloc((order - 1) * sizeof(int));
-    node->values = malloc((order - 1) * sizeof(long));
-    node->children = is_leaf ? NULL : malloc(order * sizeof(BPlusNode*));
+    BPlusNode *node = (BPlusNode *)block;
+    node->keys = (BPlusKey *)(block + keys_offset);
+    node->postings = is_leaf ? (BPlusPostings *)(block + payload_offset) : NULL;
+    node->children = is_leaf ? NULL : (BPlusNode **)(block + payload_offset);
     node->num_keys = 0;
     node->is_leaf = is_leaf;
     node->next = NULL;
-    node->parent = NULL; // Inicializar pai
+    node->page_id = 0;
 
-    if (!node->keys || !node->values || (!is_leaf && !node->children)) {
-        bplus_destroy_node(node);
-        return NULL;
+    return node;
+}
+
+// =============================================================================
+// INSERÇÃO
+// =============================================================================
+
+// Índice do filho que pode conter a chave: cada chave separadora é a menor
+// chave da subárvore à sua direita, então desce-se pela primeira chave > key
+// (busca binária sobre as chaves ordenadas do nó)
+static int bplus_child_index(const BPlusKey *keys, int num_keys, BPlusKey key) {
+    int low = 0, high = num_keys;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (keys[mid] <= key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
+    return low;
+}
 
-    return node;
+// Primeira posição da folha com chave >= key (busca binária)
+static int bplus_leaf_position(const BPlusKey *keys, int num_keys, BPlusKey key) {
+    int low = 0, high = num_keys;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (keys[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
 }
 
-// Função para dividir nó quando fica cheio
-BPlusNode* bplus_split_node(BPlusTree *tree, BPlusNode *node) {
-    if (!tree || !node) return NULL;
+// Divide uma folha transbordada; a metade direita vai para o irmão
+static void bplus_split_leaf(BPlusTree *tree, BPlusNode *node, BPlusNode *sibling, BPlusKey *split_key) {
+    int left = node->num_keys / 2;
 
-    int mid = tree->order / 2;
-    BPlusNode *new_node = bplus_create_node(tree->order, node->is_leaf);
-    if (!new_node) return NULL;
+    sibling->num_keys = node->num_keys - left;
+    memcpy(sibling->keys, &node->keys[left], sibling->num_keys * sizeof(BPlusKey));
+    memcpy(sibling->postings, &node->postings[left], sibling->num_keys * sizeof(BPlusPostings));
+    node->num_keys = left;
 
-    // Copiar metade das chaves para o novo nó
-    for (int i = mid; i < node->num_keys; i++) {
-        new_node->keys[i - mid] = node->keys[i];
-        new_node->values[i - mid] = node->values[i];
-    }
-    new_node->num_keys = node->num_keys - mid;
+    // Manter ligação entre folhas
+    sibling->next = node->next;
+    node->next = sibling;
+
+    *split_key = sibling->keys[0];
+    tree->node_count++;
+}
+
+// Divide um nó interno transbordado; a chave do meio sobe para o pai
+static void bplus_split_internal(BPlusTree *tree, BPlusNode *node, BPlusNode *sibling, BPlusKey *split_key) {
+    int mid = node->num_keys / 2;
+
+    *split_key = node->keys[mid];
+    sibling->num_keys = node->num_keys - mid - 1;
+    memcpy(sibling->keys, &node->keys[mid + 1], sibling->num_keys * sizeof(BPlusKey));
+    memcpy(sibling->children, &node->children[mid + 1], (sibling->num_keys + 1) * sizeof(BPlusNode*));
     node->num_keys = mid;
 
+    tree->node_count++;
+}
+
+// Insere na subárvore. Se o nó se dividir, *split_node recebe o novo irmão à
+// direita e *split_key a chave que deve subir para o pai. Nós que podem se
+// dividir têm o irmão alocado antes de qualquer alteração, para que uma falha
+// de memória nunca deixe a árvore inconsistente.
+static int bplus_insert_recursive(BPlusTree *tree, BPlusNode *node, BPlusKey key, long value,
+                                  BPlusKey *split_key, BPlusNode **split_node) {
+    *split_node = NULL;
+
     if (node->is_leaf) {
-        // Manter ligação entre folhas
-        new_node->next = node->next;
-        node->next = new_node;
-    } else {
-        // Copiar ponteiros para filhos
-        for (int i = mid; i <= node->num_keys; i++) {
-            new_node->children[i - mid] = node->children[i];
-            if (new_node->children[i - mid]) {
-                new_node->children[i - mid]->parent = new_node;
-            }
+        int pos = bplus_leaf_position(node->keys, node->num_keys, key);
+
+        // Chave existente: o valor vai para a lista da chave
+        if (pos < node->num_keys && node->keys[pos] == key) {
+            int added = bplus_postings_add(&node->postings[pos], value);
+            if (added < 0) return 0;
+            tree->value_count += added;
+            return 1;
+        }
+
+        BPlusNode *sibling = NULL;
+        if (node->num_keys == tree->order - 1) {
+            sibling = bplus_create_node(tree->order, 1);
+            if (!sibling) return 0;
+        }
+
+        BPlusPostings postings;
+        bplus_postings_init(&postings);
+        if (bplus_postings_add(&postings, value) < 0) {
+            bplus_free_node_shallow(sibling);
+            return 0;
         }
+
+        memmove(&node->keys[pos + 1], &node->keys[pos], (node->num_keys - pos) * sizeof(BPlusKey));
+        memmove(&node->postings[pos + 1], &node->postings[pos], (node->num_keys - pos) * sizeof(BPlusPostings));
+        node->keys[pos] = key;
+        node->postings[pos] = postings;
+        node->num_keys++;
+        tree->key_count++;
+        tree->value_count++;
+
+        if (sibling) {
+            bplus_split_leaf(tree, node, sibling, split_key);
+            *split_node = sibling;
+        }
+        return 1;
     }
 
-    new_node->parent = node->parent;
-    tree->node_count++;
+    BPlusNode *sibling = NULL;
+    if (node->num_keys == tree->order - 1) {
+        sibling = bplus_create_node(tree->order, 0);
+        if (!sibling) return 0;
+    }
+
+    int i = bplus_child_index(node->keys, node->num_keys, key);
+    BPlusKey child_split_key;
+    BPlusNode *child_split = NULL;
+
+    if (!bplus_insert_recursive(tree, node->children[i], key, value, &child_split_key, &child_split)) {
+        bplus_free_node_shallow(sibling);
+        return 0;
+    }
+    if (!child_split) {
+        bplus_free_node_shallow(sibling);
+        return 1;
+    }
+
+    // Encaixa a chave separadora e o novo filho
+    memmove(&node->keys[i + 1], &node->keys[i], (node->num_keys - i) * sizeof(BPlusKey));
+    memmove(&node->children[i + 2], &node->children[i + 1], (node->num_keys - i) * sizeof(BPlusNode*));
+    node->keys[i] = child_split_key;
+    node->children[i + 1] = child_split;
+    node->num_keys++;
 
-    return new_node;
+    if (sibling) {
+        bplus_split_internal(tree, node, sibling, split_key);
+        *split_node = sibling;
+    }
+    return 1;
 }
 
-// Implementação de inserção
-int bplus_insert(BPlusTree *tree, int key, long value) {
-    if (!tree) return 0;
+// Implementação de inserção: chaves repetidas acumulam valores na lista
+int bplus_insert(BPlusTree *tree, BPlusKey key, long value) {
+    if (!tree || tree->map) return 0;  // Árvore mapeada é somente leitura
 
     // Se a árvore está vazia, cria o primeiro nó
     if (!tree->root) {
         tree->root = bplus_create_node(tree->order, 1);
         if (!tree->root) return 0;
-
-        tree->root->keys[0] = key;
-        tree->root->values[0] = value;
-        tree->root->num_keys = 1;
         tree->node_count = 1;
         tree->height = 1;
+    }
+
+    // Raiz cheia pode se dividir: a nova raiz é alocada antes
+    BPlusNode *new_root = NULL;
+    if (tree->root->num_keys == tree->order - 1) {
+        new_root = bplus_create_node(tree->order, 0);
+        if (!new_root) return 0;
+    }
+
+    BPlusKey split_key;
+    BPlusNode *split_node = NULL;
+    if (!bplus_insert_recursive(tree, tree->root, key, value, &split_key, &split_node)) {
+        bplus_free_node_shallow(new_root);
+        return 0;
+    }
+
+    if (!split_node) {
+        bplus_free_node_shallow(new_root);
         return 1;
     }
 
-    // Encontrar a folha
-    BPlusNode *leaf = tree->root;
-    while (!leaf->is_leaf) {
-        int i = 0;
-        while (i < leaf->num_keys && key > leaf->keys[i]) {
-            i++;
-        }
-        leaf = leaf->children[i];
+    // Propagar divisão para cima: criar nova raiz
+    new_root->keys[0] = split_key;
+    new_root->children[0] = tree->root;
+    new_root->children[1] = split_node;
+    new_root->num_keys = 1;
+
+    tree->root = new_root;
+    tree->height++;
+    tree->node_count++;
+
+    return 1;
+}
+
+// =============================================================================
+// CARGA EM LOTE
+// =============================================================================
+//
+// Constrói a árvore de baixo para cima a partir de pares já ordenados: as
+// folhas são preenchidas em sequência e cada nível interno é montado sobre o
+// nível anterior, sem descidas nem divisões.
+
+// Quantidade de itens por nó para um fator de preenchimento
+static int bplus_fill_count(int capacity, double fill_factor, int minimum) {
+    int count = (int)(capacity * fill_factor + 0.5);
+    if (count < minimum) count = minimum;
+    if (count > capacity) count = capacity;
+    return count;
+}
+
+// Libera os nós criados durante uma carga que falhou
+static void bplus_free_nodes(BPlusNode **nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        bplus_free_node_shallow(nodes[i]);
     }
+    free(nodes);
+}
 
-    // Verificar se a chave já existe na folha
-    for (int i = 0; i < leaf->num_keys; i++) {
-        if (leaf->keys[i] == key) {
-            // Permitir múltiplos valores para a mesma chave
-            return 1;
+int bplus_bulk_load(BPlusTree *tree, const BPlusEntry *entries, int count, double fill_factor) {
+    if (!tree || tree->map || tree->root || count < 0 || (count > 0 && !entries)) return 0;
+    if (count == 0) return 1;
+
+    // A entrada precisa estar ordenada por (chave, valor)
+    for (int i = 1; i < count; i++) {
+        if (entries[i].key < entries[i - 1].key ||
+            (entries[i].key == entries[i - 1].key && entries[i].value < entries[i - 1].value)) {
+            return 0;
         }
     }
 
-    // Inserir na folha se houver espaço
-    if (leaf->num_keys < tree->order - 1) {
-        int i = leaf->num_keys;
-        while (i > 0 && leaf->keys[i-1] > key) {
-            leaf->keys[i] = leaf->keys[i-1];
-            leaf->values[i] = leaf->values[i-1];
-            i--;
+    if (fill_factor <= 0.0 || fill_factor > 1.0) fill_factor = 1.0;
+    int leaf_fill = bplus_fill_count(tree->order - 1, fill_factor, 1);
+    int inner_fill = bplus_fill_count(tree->order, fill_factor, 3);
+
+    int distinct = 1;
+    for (int i = 1; i < count; i++) {
+        if (entries[i].key != entries[i - 1].key) distinct++;
+    }
+
+    // Folhas: chaves distintas em sequência, cada uma com sua lista de valores
+    int leaf_count = (distinct + leaf_fill - 1) / leaf_fill;
+    BPlusNode **level = calloc(leaf_count, sizeof(BPlusNode*));
+    if (!level) return 0;
+
+    int value_count = 0;
+    int pos = 0;
+    for (int l = 0; l < leaf_count; l++) {
+        BPlusNode *leaf = bplus_create_node(tree->order, 1);
+        if (!leaf) {
+            bplus_free_nodes(level, l);
+            return 0;
+        }
+        level[l] = leaf;
+        if (l > 0) level[l - 1]->next = leaf;
+
+        while (leaf->num_keys < leaf_fill && pos < count) {
+            BPlusPostings *postings = &leaf->postings[leaf->num_keys];
+            bplus_postings_init(postings);
+            leaf->keys[leaf->num_keys] = entries[pos].key;
+            leaf->num_keys++;
+
+            BPlusKey key = entries[pos].key;
+            for (; pos < count && entries[pos].key == key; pos++) {
+                int added = bplus_postings_add(postings, entries[pos].value);
+                if (added < 0) {
+                    bplus_free_nodes(level, l + 1);
+                    return 0;
+                }
+                value_count += added;
+            }
         }
-        leaf->keys[i] = key;
-        leaf->values[i] = value;
-        leaf->num_keys++;
-        return 1;
     }
 
-    // Se não houver espaço, dividir o nó
-    BPlusNode *new_leaf = bplus_split_node(tree, leaf);
-    if (!new_leaf) return 0;
+    // Menor chave de cada subárvore, usada como separadora no nível de cima
+    BPlusKey *low_keys = malloc(leaf_count * sizeof(BPlusKey));
+    if (!low_keys) {
+        bplus_free_nodes(level, leaf_count);
+        return 0;
+    }
+    for (int l = 0; l < leaf_count; l++) {
+        low_keys[l] = level[l]->keys[0];
+    }
 
-    // Inserir a chave no nó apropriado após a divisão
-    if (key <= leaf->keys[leaf->num_keys - 1]) {
-        return bplus_insert(tree, key, value); // Recursão simples
-    } else {
-        // Inserir no novo nó
-        int i = new_leaf->num_keys;
-        while (i > 0 && new_leaf->keys[i-1] > key) {
-            new_leaf->keys[i] = new_leaf->keys[i-1];
-            new_leaf->values[i] = new_leaf->values[i-1];
-            i--;
-        }
-        new_leaf->keys[i] = key;
-        new_leaf->values[i] = value;
-        new_leaf->num_keys++;
-    }
-
-    // Propagar divisão para cima se necessário
-    if (!leaf->parent) {
-        // Criar nova raiz
-        BPlusNode *new_root = bplus_create_node(tree->order, 0);
-        if (!new_root) return 0;
+    int node_count = leaf_count;
+    int height = 1;
+    int level_count = leaf_count;
+
+    // Níveis internos: os filhos são distribuídos por igual entre os nós, o
+    // que garante pelo menos dois filhos por nó
+    while (level_count > 1) {
+        int parent_count = (level_count + inner_fill - 1) / inner_fill;
+        BPlusNode **parents = calloc(parent_count, sizeof(BPlusNode*));
+        int built = 0, child = 0;
+
+        for (; parents && built < parent_count; built++) {
+            int children = level_count / parent_count + (built < level_count % parent_count ? 1 : 0);
+            BPlusNode *parent = bplus_create_node(tree->order, 0);
+            if (!parent) break;
+
+            parent->children[0] = level[child];
+            for (int c = 1; c < children; c++) {
+                parent->keys[c - 1] = low_keys[child + c];
+                parent->children[c] = level[child + c];
+            }
+            parent->num_keys = children - 1;
 
-        new_root->keys[0] = new_leaf->keys[0];
-        new_root->children[0] = leaf;
-        new_root->children[1] = new_leaf;
-        new_root->num_keys = 1;
+            low_keys[built] = low_keys[child];
+            parents[built] = parent;
+            child += children;
+        }
 
-        leaf->parent = new_root;
-        new_leaf->parent = new_root;
-        tree->root = new_root;
-        tree->height++;
-        tree->node_count++;
+        if (built < parent_count) {
+            // Pais já montados liberam seus filhos; o restante do nível é liberado à parte
+            for (int i = 0; i < built; i++) {
+                bplus_destroy_node(parents[i]);
+            }
+            for (int i = child; i < level_count; i++) {
+                bplus_destroy_node(level[i]);
+            }
+            free(parents);
+            free(level);
+            free(low_keys);
+            return 0;
+        }
+
+        free(level);
+        level = parents;
+        level_count = parent_count;
+        node_count += parent_count;
+        height++;
     }
 
+    tree->root = level[0];
+    tree->node_count = node_count;
+    tree->height = height;
+    tree->key_count = distinct;
+    tree->value_count = value_count;
+
+    free(level);
+    free(low_keys);
     return 1;
 }
 
-// Implementação de busca
-long* bplus_search(BPlusTree *tree, int key, int *count) {
-    *count = 0;
+// =============================================================================
+// BUSCAS
+// =============================================================================
+
+// Função auxiliar para encontrar a folha que pode conter uma chave
+BPlusNode* bplus_find_leaf_for_key(BPlusTree *tree, BPlusKey key) {
     if (!tree || !tree->root) return NULL;
 
     BPlusNode *current = tree->root;
 
     // Navega até a folha
     while (!current->is_leaf) {
-        int i = 0;
-        while (i < current->num_keys && key > current->keys[i]) {
-            i++;
-        }
-        current = current->children[i];
-    }
-
-    // Buscar todas as ocorrências da chave
-    // (para suportar múltiplos valores por chave)
-    long *all_results = malloc(1000 * sizeof(long)); // Buffer inicial
-    if (!all_results) return NULL;
-
-    int total_found = 0;
-    int buffer_size = 1000;
-
-    // Buscar na folha atual e seguintes (para chaves duplicadas)
-    while (current) {
-        for (int i = 0; i < current->num_keys; i++) {
-            if (current->keys[i] == key) {
-                // Expandir buffer se necessário
-                if (total_found >= buffer_size) {
-                    buffer_size *= 2;
-                    long *new_buffer = realloc(all_results, buffer_size * sizeof(long));
-                    if (!new_buffer) {
-                        free(all_results);
-                        return NULL;
-                    }
-                    all_results = new_buffer;
-                }
+        current = current->children[bplus_child_index(current->keys, current->num_keys, key)];
+    }
+
+    return current;
+}
 
-                all_results[total_found++] = current->values[i];
-            } else if (current->keys[i] > key) {
-                // Chegou além da chave procurada
+// Implementação de busca: devolve a lista de valores da chave em ordem crescente
+long* bplus_search(BPlusTree *tree, BPlusKey key, int *count) {
+    *count = 0;
+    if (tree && tree->map) return bplus_mapped_search(tree, key, count);
+    if (!tree || !tree->root) return NULL;
+
+    BPlusNode *leaf = bplus_find_leaf_for_key(tree, key);
+    int pos = bplus_leaf_position(leaf->keys, leaf->num_keys, key);
+    if (pos >= leaf->num_keys || leaf->keys[pos] != key) return NULL;
+
+    BPlusPostingsCursor cursor;
+    bplus_cursor_init(&cursor, leaf->postings[pos].data, leaf->postings[pos].size, leaf->postings[pos].count);
+    return bplus_merge_postings(&cursor, 1, leaf->postings[pos].count, count);
+}
+
+// Busca por intervalo: percorre as folhas encadeadas e intercala as listas
+// das chaves do intervalo, devolvendo os valores em ordem crescente
+long* bplus_search_range(BPlusTree *tree, BPlusKey min_key, BPlusKey max_key, int *count) {
+    *count = 0;
+    if (tree && tree->map) return bplus_mapped_search_range(tree, min_key, max_key, count);
+    if (!tree || !tree->root || min_key > max_key) return NULL;
+
+    BPlusCursorList lists = {NULL, 0, 0, 0};
+    BPlusNode *leaf = bplus_find_leaf_for_key(tree, min_key);
+    int pos = bplus_leaf_position(leaf->keys, leaf->num_keys, min_key);
+    bool done = false;
+
+    while (leaf && !done) {
+        for (; pos < leaf->num_keys; pos++) {
+            if (leaf->keys[pos] > max_key) {
+                done = true;
                 break;
             }
+            BPlusPostings *postings = &leaf->postings[pos];
+            if (!bplus_cursor_list_add(&lists, postings->data, postings->size, postings->count)) {
+                free(lists.items);
+                return NULL;
+            }
         }
+        leaf = leaf->next;
+        pos = 0;
+    }
 
-        // Verifica próxima folha apenas se ainda pode haver chaves iguais
-        if (current->next && current->next->num_keys > 0 &&
-            current->next->keys[0] <= key) {
-            current = current->next;
-        } else {
-            break;
-        }
+    long *results = bplus_merge_postings(lists.items, lists.count, lists.total_values, count);
+    free(lists.items);
+    return results;
+}
+
+// =============================================================================
+// PERSISTÊNCIA EM PÁGINAS
+// =============================================================================
+//
+// Layout do arquivo: a página 0 guarda o cabeçalho e as páginas 1..page_count
+// guardam um nó cada. Todas as páginas têm o mesmo tamanho (page_size), então
+// o nó da página p começa em p * page_size. Dentro da página:
+//   BPlusPageHeader | área de ligações | BPlusKey keys[order-1]
+// Em folhas a área de ligações guarda um BPlusPageEntry por chave, apontando
+// para a lista de valores na região de listas que segue a última página; em
+// nós internos guarda int children[order]. Filhos e a ligação entre folhas
+// são números de página (BPLUS_NO_PAGE = nenhum).
+
+#define BPLUS_FILE_MAGIC 0x31545042  // "BPT1"
+#define BPLUS_FILE_VERSION 3
+#define BPLUS_NO_PAGE (-1)
+
+typedef struct {
+    int magic;
+    int version;
+    int order;
+    int page_size;
+    int page_count;
+    int root_page;
+    int first_leaf_page;
+    int node_count;
+    int height;
+    int key_count;
+    int value_count;
+    int reserved;
+    long long postings_offset;  // Início da região de listas no arquivo
+    long long postings_size;    // Bytes da região de listas
+} BPlusFileHeader;
+
+typedef struct {
+    int is_leaf;
+    int num_keys;
+    int next_page;
+    int reserved;
+} BPlusPageHeader;
+
+typedef struct {
+    long long offset;  // Posição da lista, relativa ao início da região
+    int count;
+    int size;
+} BPlusPageEntry;
+
+static int bplus_link_area_size(int order) {
+    int entries = (order - 1) * sizeof(BPlusPageEntry);
+    int children = order * sizeof(int);
+    return entries > children ? entries : children;
+}
+
+// Tamanho da página para uma ordem, arredondado para múltiplo de 64 bytes
+static int bplus_page_size(int order) {
+    int size = sizeof(BPlusPageHeader) + bplus_link_area_size(order) + (order - 1) * sizeof(BPlusKey);
+    if (size < (int)sizeof(BPlusFileHeader)) {
+        size = sizeof(BPlusFileHeader);
     }
+    return (size + 63) & ~63;
+}
 
-    if (total_found == 0) {
-        free(all_results);
-        return NULL;
+// Adiciona um nó à lista de páginas, numerando-o a partir de 1
+static int bplus_append_page_node(BPlusNode *node, BPlusNode ***nodes, int *count, int *capacity) {
+    if (*count >= *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity * 2 : 64;
+        BPlusNode **new_nodes = realloc(*nodes, new_capacity * sizeof(BPlusNode*));
+        if (!new_nodes) return 0;
+        *nodes = new_nodes;
+        *capacity = new_capacity;
     }
+    (*nodes)[(*count)++] = node;
+    node->page_id = *count;
+    return 1;
+}
 
-    *count = total_found;
+static int bplus_collect_page_nodes(BPlusNode *node, BPlusNode ***nodes, int *count, int *capacity) {
+    if (!node) return 1;
+    if (!bplus_append_page_node(node, nodes, count, capacity)) return 0;
 
-    // Redimensionar para o tamanho exato
-    if (total_found < buffer_size) {
-        long *final_result = realloc(all_results, total_found * sizeof(long));
-        if (final_result) {
-            all_results = final_result;
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->num_keys; i++) {
+            if (!bplus_collect_page_nodes(node->children[i], nodes, count, capacity)) return 0;
         }
     }
-
-    return all_results;
+    return 1;
 }
 
-// Função auxiliar para encontrar a folha que pode conter uma chave
-BPlusNode* bplus_find_leaf_for_key(BPlusTree *tree, int key) {
-    if (!tree || !tree->root) return NULL;
+int bplus_save_to_file(BPlusTree *tree) {
+    if (!tree || tree->map) return 0;  // Árvore mapeada não tem nós em memória
 
-    BPlusNode *current = tree->root;
+    // Numera os nós pela descida a partir da raiz
+    BPlusNode **nodes = NULL;
+    int count = 0, capacity = 0;
+    int first_leaf_page = BPLUS_NO_PAGE;
 
-    // Navega até a folha
-    while (!current->is_leaf) {
-        int i = 0;
-        while (i < current->num_keys && key > current->keys[i]) {
-            i++;
+    if (tree->root) {
+        if (!bplus_collect_page_nodes(tree->root, &nodes, &count, &capacity)) {
+            free(nodes);
+            return 0;
+        }
+
+        BPlusNode *leaf = tree->root;
+        while (!leaf->is_leaf) {
+            leaf = leaf->children[0];
         }
-        current = current->children[i];
+        first_leaf_page = leaf->page_id;
     }
 
-    return current;
-}
+    int page_size = bplus_page_size(tree->order);
+    unsigned char *page = calloc(1, page_size);
 
-// Função auxiliar para coletar valores em um intervalo
-void bplus_collect_range_values(BPlusNode *node, int min_key, int max_key, long **results, int *count, int *capacity) {
-    if (!node) return;
+    // Grava em arquivo temporário e renomeia no final, para que processos com
+    // o índice mapeado nunca vejam um arquivo truncado
+    char temp_filename[sizeof(tree->filename) + 8];
+    snprintf(temp_filename, sizeof(temp_filename), "%s.tmp", tree->filename);
+
+    FILE *file = fopen(temp_filename, "wb");
+    if (!page || !file) {
+        free(page);
+        free(nodes);
+        if (file) fclose(file);
+        return 0;
+    }
+
+    // Tamanho da região de listas (gravada na mesma ordem das páginas)
+    long long postings_size = 0;
+    for (int p = 0; p < count; p++) {
+        if (!nodes[p]->is_leaf) continue;
+        for (int i = 0; i < nodes[p]->num_keys; i++) {
+            postings_size += nodes[p]->postings[i].size;
+        }
+    }
 
-    for (int i = 0; i < node->num_keys; i++) {
-        if (node->keys[i] >= min_key && node->keys[i] <= max_key) {
-            // Expandir buffer se necessário
-            if (*count >= *capacity) {
-                *capacity *= 2;
-                long *new_buffer = realloc(*results, (*capacity) * sizeof(long));
-                if (!new_buffer) return;
-                *results = new_buffer;
+    // Página 0: cabeçalho
+    BPlusFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BPLUS_FILE_MAGIC;
+    header.version = BPLUS_FILE_VERSION;
+    header.order = tree->order;
+    header.page_size = page_size;
+    header.page_count = count;
+    header.root_page = tree->root ? tree->root->page_id : BPLUS_NO_PAGE;
+    header.first_leaf_page = first_leaf_page;
+    header.node_count = tree->node_count;
+    header.height = tree->height;
+    header.key_count = tree->key_count;
+    header.value_count = tree->value_count;
+    header.postings_offset = (long long)(count + 1) * page_size;
+    header.postings_size = postings_size;
+
+    memcpy(page, &header, sizeof(header));
+    int success = fwrite(page, page_size, 1, file) == 1;
+
+    // Páginas dos nós
+    unsigned char *link_area = page + sizeof(BPlusPageHeader);
+    BPlusPageEntry *entries = (BPlusPageEntry *)link_area;
+    int *children = (int *)link_area;
+    BPlusKey *keys = (BPlusKey *)(link_area + bplus_link_area_size(tree->order));
+    long long postings_offset = 0;
+
+    for (int p = 0; p < count && success; p++) {
+        BPlusNode *node = nodes[p];
+        memset(page, 0, page_size);
+
+        BPlusPageHeader *page_header = (BPlusPageHeader *)page;
+        page_header->is_leaf = node->is_leaf;
+        page_header->num_keys = node->num_keys;
+        page_header->next_page = (node->is_leaf && node->next) ? node->next->page_id : BPLUS_NO_PAGE;
+
+        for (int i = 0; i < node->num_keys; i++) {
+            keys[i] = node->keys[i];
+        }
+        if (node->is_leaf) {
+            for (int i = 0; i < node->num_keys; i++) {
+                entries[i].offset = postings_offset;
+                entries[i].count = node->postings[i].count;
+                entries[i].size = node->postings[i].size;
+                postings_offset += node->postings[i].size;
+            }
+        } else {
+            for (int i = 0; i <= node->num_keys; i++) {
+                children[i] = node->children[i]->page_id;
             }
+        }
 
-            (*results)[(*count)++] = node->values[i];
-        } else if (node->keys[i] > max_key) {
-            // Parou de encontrar chaves no intervalo
-            break;
+        success = fwrite(page, page_size, 1, file) == 1;
+    }
+
+    // Região de listas
+    for (int p = 0; p < count && success; p++) {
+        if (!nodes[p]->is_leaf) continue;
+        for (int i = 0; i < nodes[p]->num_keys && success; i++) {
+            BPlusPostings *postings = &nodes[p]->postings[i];
+            if (postings->size > 0) {
+                success = fwrite(postings->data, postings->size, 1, file) == 1;
+            }
         }
     }
+
+    if (fclose(file) != 0) success = 0;
+    free(page);
+    free(nodes);
+
+#ifdef _WIN32
+    // rename() do Windows não substitui um arquivo existente
+    if (success) remove(tree->filename);
+#endif
+    if (success && rename(temp_filename, tree->filename) != 0) success = 0;
+    if (!success) remove(temp_filename);
+
+    return success;
 }
 
-// Nova implementação de busca por intervalo
-long* bplus_search_range(BPlusTree *tree, int min_key, int max_key, int *count) {
-    *count = 0;
-    if (!tree || !tree->root || min_key > max_key) return NULL;
+// Valida o cabeçalho lido do arquivo contra o tamanho total do arquivo
+static bool bplus_header_is_valid(const BPlusFileHeader *header, long long file_size) {
+    return header->magic == BPLUS_FILE_MAGIC &&
+           header->version == BPLUS_FILE_VERSION &&
+           header->order >= BPLUS_MIN_ORDER && header->order <= BPLUS_MAX_ORDER &&
+           header->page_size == bplus_page_size(header->order) &&
+           header->page_count >= 0 &&
+           (header->page_count == 0) == (header->root_page == BPLUS_NO_PAGE) &&
+           (header->page_count == 0 || (header->root_page >= 1 && header->root_page <= header->page_count)) &&
+           header->postings_offset == (long long)(header->page_count + 1) * header->page_size &&
+           header->postings_size >= 0 &&
+           header->postings_offset + header->postings_size <= file_size;
+}
 
-    // Encontra primeira folha que pode conter min_key
-    BPlusNode *current = bplus_find_leaf_for_key(tree, min_key);
-    if (!current) return NULL;
+// Verifica se a lista de uma entrada está dentro da região de listas
+static bool bplus_entry_is_valid(const BPlusPageEntry *entry, long long postings_size) {
+    return entry->count > 0 && entry->size > 0 && entry->offset >= 0 &&
+           entry->offset + entry->size <= postings_size;
+}
 
-    // Buffer inicial para resultados
-    int capacity = 1000;
-    long *results = malloc(capacity * sizeof(long));
-    if (!results) return NULL;
+BPlusTree* bplus_load_from_file(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return NULL;
 
-    // Percorre folhas coletando valores no intervalo
-    while (current) {
-        bool found_in_leaf = false;
+    // Valida o cabeçalho
+    BPlusFileHeader header;
+    long long file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) file_size = ftell(file);
+    if (file_size < 0 || fseek(file, 0, SEEK_SET) != 0 ||
+        fread(&header, sizeof(header), 1, file) != 1 ||
+        !bplus_header_is_valid(&header, file_size)) {
+        fclose(file);
+        return NULL;
+    }
 
-        // Coletar valores desta folha que estão no intervalo
-        bplus_collect_range_values(current, min_key, max_key, &results, count, &capacity);
+    BPlusTree *tree = bplus_create(filename);
+    unsigned char *page = malloc(header.page_size);
+    unsigned char *postings_region = malloc(header.postings_size > 0 ? header.postings_size : 1);
+    BPlusNode **nodes = calloc(header.page_count + 1, sizeof(BPlusNode*));
+    int *links = malloc((size_t)(header.page_count + 1) * (header.order + 1) * sizeof(int));
+    if (!tree || !page || !postings_region || !nodes || !links) {
+        free(tree);
+        free(page);
+        free(postings_region);
+        free(nodes);
+        free(links);
+        fclose(file);
+        return NULL;
+    }
 
-        // Verificar se encontrou algo nesta folha
-        for (int i = 0; i < current->num_keys; i++) {
-            if (current->keys[i] >= min_key && current->keys[i] <= max_key) {
-                found_in_leaf = true;
-                break;
-            }
+    tree->order = header.order;
+    unsigned char *link_area = page + sizeof(BPlusPageHeader);
+    BPlusPageEntry *entries = (BPlusPageEntry *)link_area;
+    int *children = (int *)link_area;
+    BPlusKey *keys = (BPlusKey *)(link_area + bplus_link_area_size(header.order));
+
+    // A região de listas é lida de uma vez e copiada para cada chave
+    bool ok = fseek(file, header.postings_offset, SEEK_SET) == 0 &&
+              (header.postings_size == 0 ||
+               fread(postings_region, header.postings_size, 1, file) == 1) &&
+              fseek(file, header.page_size, SEEK_SET) == 0;
+
+    // Primeira passada: lê cada página para um nó, guardando as ligações
+    // (filhos e próxima folha) como números de página
+    for (int p = 0; p < header.page_count && ok; p++) {
+        BPlusPageHeader *page_header = (BPlusPageHeader *)page;
+        if (fread(page, header.page_size, 1, file) != 1 ||
+            page_header->num_keys < 0 || page_header->num_keys > header.order - 1) {
+            ok = false;
+            break;
         }
 
-        // Se todas as chaves desta folha são maiores que max_key, parar
-        if (current->num_keys > 0 && current->keys[0] > max_key) {
+        BPlusNode *node = bplus_create_node(header.order, page_header->is_leaf);
+        if (!node) {
+            ok = false;
             break;
         }
+        nodes[p] = node;
 
-        current = current->next;
+        for (int i = 0; i < page_header->num_keys && ok; i++) {
+            node->keys[i] = keys[i];
+            if (!node->is_leaf) continue;
 
-        // Se não encontrou nada nesta folha e já passou do min_key, pode parar
-        if (!found_in_leaf && current && current->num_keys > 0 &&
-            current->keys[0] > max_key) {
-            break;
+            BPlusPostings *postings = &node->postings[i];
+            bplus_postings_init(postings);
+            if (!bplus_entry_is_valid(&entries[i], header.postings_size) ||
+                !bplus_postings_reserve(postings, entries[i].size)) {
+                ok = false;
+                break;
+            }
+            memcpy(postings->data, postings_region + entries[i].offset, entries[i].size);
+            postings->size = entries[i].size;
+            postings->count = entries[i].count;
+            bplus_postings_refresh_last(postings);
+            node->num_keys = i + 1;
+        }
+        if (!ok) break;
+        node->num_keys = page_header->num_keys;
+
+        int *node_links = &links[p * (header.order + 1)];
+        node_links[0] = page_header->next_page;
+        for (int i = 0; i < header.order; i++) {
+            node_links[i + 1] = node->is_leaf ? BPLUS_NO_PAGE : children[i];
+        }
+
+        // Valida os números de página antes de ligar os nós
+        if (node_links[0] != BPLUS_NO_PAGE &&
+            (node_links[0] < 1 || node_links[0] > header.page_count)) {
+            ok = false;
+        }
+        for (int i = 0; !node->is_leaf && i <= node->num_keys; i++) {
+            if (node_links[i + 1] < 1 || node_links[i + 1] > header.page_count) {
+                ok = false;
+            }
         }
     }
 
-    if (*count == 0) {
-        free(results);
+    free(page);
+    free(postings_region);
+    fclose(file);
+
+    if (!ok) {
+        for (int p = 0; p < header.page_count; p++) {
+            bplus_free_node_shallow(nodes[p]);
+        }
+        free(tree);
+        free(nodes);
+        free(links);
         return NULL;
     }
 
-    // Redimensionar para o tamanho exato
-    if (*count < capacity) {
-        long *final_result = realloc(results, (*count) * sizeof(long));
-        if (final_result) {
-            results = final_result;
+    // Segunda passada: resolve os números de página em ponteiros
+    for (int p = 0; p < header.page_count; p++) {
+        BPlusNode *node = nodes[p];
+        int *node_links = &links[p * (header.order + 1)];
+
+        node->page_id = p + 1;
+        if (node->is_leaf) {
+            node->next = node_links[0] != BPLUS_NO_PAGE ? nodes[node_links[0] - 1] : NULL;
+        } else {
+            for (int i = 0; i <= node->num_keys; i++) {
+                node->children[i] = nodes[node_links[i + 1] - 1];
+            }
         }
     }
 
-    return results;
+    tree->root = header.page_count > 0 ? nodes[header.root_page - 1] : NULL;
+    tree->node_count = header.node_count;
+    tree->height = header.height;
+    tree->key_count = header.key_count;
+    tree->value_count = header.value_count;
+
+    free(nodes);
+    free(links);
+    return tree;
 }
 
-// Implementação de busca por intervalo (alternativa mais simples)
-long* bplus_search_range_simple(BPlusTree *tree, int min_key, int max_key, int *count) {
-    *count = 0;
-    if (!tree || !tree->root || min_key > max_key) return NULL;
+// =============================================================================
+// MODO SOMENTE LEITURA SOBRE ARQUIVO MAPEADO
+// =============================================================================
+//
+// A árvore aberta com bplus_open_mapped não tem nós no heap: as buscas andam
+// pelas páginas do arquivo usando os números de página gravados no disco e
+// decodificam as listas de valores diretamente do mapeamento.
+// Vários processos que mapeiam o mesmo arquivo compartilham o page cache.
+// Sem mmap (Windows) o arquivo é lido inteiro para um único buffer.
+
+// Visão de uma página do arquivo
+typedef struct {
+    const BPlusPageHeader *header;
+    const BPlusPageEntry *entries;
+    const int *children;
+    const BPlusKey *keys;
+} BPlusPageView;
+
+static bool bplus_mapped_page(const BPlusTree *tree, int page_id, BPlusPageView *view) {
+    if (page_id < 1 || page_id > tree->page_count) return false;
+
+    const unsigned char *page = tree->map + (size_t)page_id * tree->page_size;
+    const unsigned char *link_area = page + sizeof(BPlusPageHeader);
+    view->header = (const BPlusPageHeader *)page;
+    view->entries = (const BPlusPageEntry *)link_area;
+    view->children = (const int *)link_area;
+    view->keys = (const BPlusKey *)(link_area + bplus_link_area_size(tree->order));
+
+    return view->header->num_keys >= 0 && view->header->num_keys <= tree->order - 1;
+}
 
-    // Buffer para todos os resultados
-    int capacity = 10000;
-    long *all_results = malloc(capacity * sizeof(long));
-    if (!all_results) return NULL;
-
-    int total_found = 0;
-
-    // Buscar cada chave no intervalo individualmente
-    for (int key = min_key; key <= max_key; key++) {
-        int key_count = 0;
-        long *key_results = bplus_search(tree, key, &key_count);
-
-        if (key_results && key_count > 0) {
-            // Verificar se há espaço suficiente
-            while (total_found + key_count >= capacity) {
-                capacity *= 2;
-                long *new_buffer = realloc(all_results, capacity * sizeof(long));
-                if (!new_buffer) {
-                    free(all_results);
-                    free(key_results);
-                    return NULL;
-                }
-                all_results = new_buffer;
-            }
+// Desce da raiz até a folha que pode conter a chave (0 se o arquivo é inválido)
+static int bplus_mapped_find_leaf(const BPlusTree *tree, BPlusKey key) {
+    int page_id = tree->root_page;
+    BPlusPageView view;
 
-            // Copiar resultados desta chave
-            for (int i = 0; i < key_count; i++) {
-                all_results[total_found++] = key_results[i];
-            }
+    // Uma descida válida nunca visita mais páginas do que o arquivo tem
+    for (int depth = 0; depth < tree->page_count; depth++) {
+        if (!bplus_mapped_page(tree, page_id, &view)) return 0;
+        if (view.header->is_leaf) return page_id;
 
-            free(key_results);
-        }
+        page_id = view.children[bplus_child_index(view.keys, view.header->num_keys, key)];
     }
+    return 0;
+}
 
-    if (total_found == 0) {
-        free(all_results);
-        return NULL;
+// Adiciona a lista de uma entrada da folha à lista de cursores
+static bool bplus_mapped_add_entry(const BPlusTree *tree, const BPlusPageEntry *entry, BPlusCursorList *lists) {
+    const BPlusFileHeader *header = (const BPlusFileHeader *)tree->map;
+    if (!bplus_entry_is_valid(entry, header->postings_size)) return false;
+
+    const unsigned char *data = tree->map + header->postings_offset + entry->offset;
+    return bplus_cursor_list_add(lists, data, entry->size, entry->count);
+}
+
+static long* bplus_mapped_search(BPlusTree *tree, BPlusKey key, int *count) {
+    *count = 0;
+    if (tree->page_count == 0) return NULL;
+
+    BPlusPageView view;
+    int page_id = bplus_mapped_find_leaf(tree, key);
+    if (!page_id || !bplus_mapped_page(tree, page_id, &view)) return NULL;
+
+    int pos = bplus_leaf_position(view.keys, view.header->num_keys, key);
+    if (pos >= view.header->num_keys || view.keys[pos] != key) return NULL;
+
+    BPlusCursorList lists = {NULL, 0, 0, 0};
+    long *results = NULL;
+    if (bplus_mapped_add_entry(tree, &view.entries[pos], &lists)) {
+        results = bplus_merge_postings(lists.items, lists.count, lists.total_values, count);
     }
+    free(lists.items);
+    return results;
+}
 
-    *count = total_found;
+static long* bplus_mapped_search_range(BPlusTree *tree, BPlusKey min_key, BPlusKey max_key, int *count) {
+    *count = 0;
+    if (tree->page_count == 0 || min_key > max_key) return NULL;
+
+    BPlusCursorList lists = {NULL, 0, 0, 0};
+    BPlusPageView view;
+    int page_id = bplus_mapped_find_leaf(tree, min_key);
+    bool done = false;
+
+    // Percorre as folhas pela ligação entre páginas até passar de max_key
+    for (int visited = 0; page_id && !done && visited < tree->page_count; visited++) {
+        if (!bplus_mapped_page(tree, page_id, &view)) break;
 
-    // Redimensionar para o tamanho exato
-    if (total_found < capacity) {
-        long *final_result = realloc(all_results, total_found * sizeof(long));
-        if (final_result) {
-            all_results = final_result;
+        int pos = visited == 0 ? bplus_leaf_position(view.keys, view.header->num_keys, min_key) : 0;
+        for (; pos < view.header->num_keys; pos++) {
+            if (view.keys[pos] > max_key) {
+                done = true;
+                break;
+            }
+            if (!bplus_mapped_add_entry(tree, &view.entries[pos], &lists)) {
+                free(lists.items);
+                return NULL;
+            }
         }
+
+        page_id = view.header->next_page;
+        if (page_id == BPLUS_NO_PAGE) break;
     }
 
-    return all_results;
+    long *results = bplus_merge_postings(lists.items, lists.count, lists.total_values, count);
+    free(lists.items);
+    return results;
 }
 
-// Salvar e carregar
-int bplus_save_to_file(BPlusTree *tree) {
-    if (!tree) return 0;
-
-    FILE *file = fopen(tree->filename, "wb");
-    if (!file) return 0;
+static void bplus_unmap_file(BPlusTree *tree) {
+    if (!tree->map) return;
 
-    // Salva metadados da árvore
-    fwrite(&tree->order, sizeof(int), 1, file);
-    fwrite(&tree->node_count, sizeof(int), 1, file);
-    fwrite(&tree->height, sizeof(int), 1, file);
+#ifdef _WIN32
+    free((void *)tree->map);
+#else
+    munmap((void *)tree->map, tree->map_size);
+#endif
+    tree->map = NULL;
+    tree->map_size = 0;
+}
 
-    // Salva estrutura da árvore
-    int success = 1;
-    fwrite(&success, sizeof(int), 1, file);
-    fclose(file);
+BPlusTree* bplus_open_mapped(const char *filename) {
+    if (!filename) return NULL;
 
-    return 1;
-}
+    const unsigned char *map = NULL;
+    size_t map_size = 0;
 
-BPlusTree* bplus_load_from_file(const char *filename) {
+#ifdef _WIN32
     FILE *file = fopen(filename, "rb");
     if (!file) return NULL;
 
-    BPlusTree *tree = malloc(sizeof(BPlusTree));
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            unsigned char *buffer = malloc(size);
+            if (buffer && fread(buffer, size, 1, file) == 1) {
+                map = buffer;
+                map_size = size;
+            } else {
+                free(buffer);
+            }
+        }
+    }
+    fclose(file);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            map = addr;
+            map_size = st.st_size;
+        }
+    }
+    // O mapeamento continua válido depois de fechar o descritor
+    close(fd);
+#endif
+
+    if (!map) return NULL;
+
+    BPlusTree *tree = bplus_create(filename);
     if (!tree) {
-        fclose(file);
+#ifdef _WIN32
+        free((void *)map);
+#else
+        munmap((void *)map, map_size);
+#endif
         return NULL;
     }
-
-    // Carrega metadados
-    if (fread(&tree->order, sizeof(int), 1, file) != 1 ||
-        fread(&tree->node_count, sizeof(int), 1, file) != 1 ||
-        fread(&tree->height, sizeof(int), 1, file) != 1) {
-        free(tree);
-        fclose(file);
+    tree->map = map;
+    tree->map_size = map_size;
+
+    // Valida o cabeçalho e o tamanho do arquivo
+    const BPlusFileHeader *header = (const BPlusFileHeader *)map;
+    if (map_size < sizeof(BPlusFileHeader) ||
+        !bplus_header_is_valid(header, (long long)map_size)) {
+        bplus_destroy(tree);
         return NULL;
     }
 
-    strncpy(tree->filename, filename, sizeof(tree->filename) - 1);
-    tree->filename[sizeof(tree->filename) - 1] = '\0';
-
-    // Inicializa com árvore vazia
-    tree->root = NULL;
+    tree->order = header->order;
+    tree->page_size = header->page_size;
+    tree->page_count = header->page_count;
+    tree->root_page = header->root_page;
+    tree->node_count = header->node_count;
+    tree->height = header->height;
+    tree->key_count = header->key_count;
+    tree->value_count = header->value_count;
 
-    fclose(file);
     return tree;
 }
 
+int bplus_is_mapped(const BPlusTree *tree) {
+    return tree && tree->map;
+}
+
+// =============================================================================
+// ESTATÍSTICAS
+// =============================================================================
+
 // Função para imprimir estatísticas
 void bplus_print_statistics(BPlusTree *tree) {
     if (!tree) return;
@@ -499,7 +1442,12 @@ void bplus_print_statistics(BPlusTree *tree) {
     printf("Order: %d\n", tree->order);
     printf("Node count: %d\n", tree->node_count);
     printf("Height: %d\n", tree->height);
+    printf("Distinct keys: %d\n", tree->key_count);
+    printf("Stored values: %d\n", tree->value_count);
     printf("Filename: %s\n", tree->filename);
+    if (tree->map) {
+        printf("Mapped read-only: %d pages of %d bytes\n", tree->page_count, tree->page_size);
+    }
 
     if (tree->root) {
         int leaf_count = 0;
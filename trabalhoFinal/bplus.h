@@ -7,25 +7,49 @@ typedef struct BPlusTree BPlusTree;
 // Forward declaration para evitar erro de tipo desconhecido
 typedef struct BPlusNode BPlusNode;
 
+// Chave de 64 bits: comporta valores como danos e afetados sem truncamento
+typedef long long BPlusKey;
+
+// Ordem (máximo de filhos por nó). A ordem padrão deixa um nó interno com
+// cerca de uma dúzia de linhas de cache, reduzindo a altura da árvore.
+#define BPLUS_MIN_ORDER 3
+#define BPLUS_MAX_ORDER 1024
+#define BPLUS_DEFAULT_ORDER 64
+
 // Funções básicas da B+ Tree
 BPlusTree* bplus_create(const char *filename);
+BPlusTree* bplus_create_with_order(const char *filename, int order);  // NULL se a ordem for inválida
+int bplus_get_order(const BPlusTree *tree);
 void bplus_destroy(BPlusTree *tree);
-int bplus_insert(BPlusTree *tree, int key, long value);
-long* bplus_search(BPlusTree *tree, int key, int *count);
+int bplus_insert(BPlusTree *tree, BPlusKey key, long value);
+long* bplus_search(BPlusTree *tree, BPlusKey key, int *count);
 
-// Nova função implementada: busca por intervalo
-long* bplus_search_range(BPlusTree *tree, int min_key, int max_key, int *count);
+// Carga em lote: constrói uma árvore vazia a partir de pares ordenados por
+// (chave, valor), preenchendo cada nó até fill_factor (0 < f <= 1; valores
+// fora do intervalo usam 1.0). Retorna 0 se a árvore não estiver vazia, se a
+// entrada não estiver ordenada ou se faltar memória.
+typedef struct {
+    BPlusKey key;
+    long value;
+} BPlusEntry;
 
-// Função alternativa de busca por intervalo (implementação mais simples)
-long* bplus_search_range_simple(BPlusTree *tree, int min_key, int max_key, int *count);
+int bplus_bulk_load(BPlusTree *tree, const BPlusEntry *entries, int count, double fill_factor);
+
+// Nova função implementada: busca por intervalo
+long* bplus_search_range(BPlusTree *tree, BPlusKey min_key, BPlusKey max_key, int *count);
 
 // Funções de estatísticas
 void bplus_print_statistics(BPlusTree *tree);
 
-// Funções de persistência
+// Funções de persistência (arquivo paginado: cabeçalho + uma página por nó)
 int bplus_save_to_file(BPlusTree *tree);
 BPlusTree* bplus_load_from_file(const char *filename);
 
+// Abre o arquivo salvo em modo somente leitura (mmap): as buscas percorrem as
+// páginas do arquivo sem criar nós em memória e bplus_insert retorna 0
+BPlusTree* bplus_open_mapped(const char *filename);
+int bplus_is_mapped(const BPlusTree *tree);
+
 // Declaração da função auxiliar interna
 void bplus_count_nodes(BPlusNode *node, int *leaf_count, int *internal_count, int *total_keys);
 
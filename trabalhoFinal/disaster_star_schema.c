@@ -7,12 +7,163 @@
 #include <stdlib.h>
 #include <string.h>
 
+// =============================================================================
+// ÍNDICES HASH DAS CHAVES NATURAIS
+// =============================================================================
+
+// Menor potência de 2 maior ou igual ao dobro da capacidade
+static int dw_hash_table_size(int capacity) {
+    int size = 16;
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+    return size;
+}
+
+static unsigned int dw_hash_date(int year, int month, int day) {
+    unsigned int hash = (unsigned int)year * 2654435761u;
+    hash ^= (unsigned int)month * 2246822519u;
+    hash ^= (unsigned int)day * 3266489917u;
+    return hash ^ (hash >> 15);
+}
+
+static unsigned int dw_hash_text(const char *str) {
+    unsigned int hash = 5381;
+    int c;
+    while ((c = (unsigned char)*str++))
+        hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+// Registra a linha na tabela hash; se a chave natural já existe, mantém a
+// primeira linha (mesma semântica da antiga busca linear)
+static void dw_hash_insert_time(DataWarehouse *dw, int row) {
+    DimTime *entry = &dw->dim_time[row];
+    unsigned int mask = dw->time_hash_size - 1;
+    unsigned int slot = dw_hash_date(entry->start_year, entry->start_month, entry->start_day) & mask;
+
+    while (dw->time_hash[slot]) {
+        DimTime *other = &dw->dim_time[dw->time_hash[slot] - 1];
+        if (other->start_year == entry->start_year &&
+            other->start_month == entry->start_month &&
+            other->start_day == entry->start_day) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    dw->time_hash[slot] = row + 1;
+}
+
+static void dw_hash_insert_geography(DataWarehouse *dw, int row) {
+    const char *country = dw->dim_geography[row].country;
+    unsigned int mask = dw->geography_hash_size - 1;
+    unsigned int slot = dw_hash_text(country) & mask;
+
+    while (dw->geography_hash[slot]) {
+        if (strcmp(dw->dim_geography[dw->geography_hash[slot] - 1].country, country) == 0) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    dw->geography_hash[slot] = row + 1;
+}
+
+static void dw_hash_insert_disaster_type(DataWarehouse *dw, int row) {
+    const char *disaster_type = dw->dim_disaster_type[row].disaster_type;
+    unsigned int mask = dw->disaster_type_hash_size - 1;
+    unsigned int slot = dw_hash_text(disaster_type) & mask;
+
+    while (dw->disaster_type_hash[slot]) {
+        if (strcmp(dw->dim_disaster_type[dw->disaster_type_hash[slot] - 1].disaster_type,
+                   disaster_type) == 0) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    dw->disaster_type_hash[slot] = row + 1;
+}
+
+// Codifica as strings das dimensões no dicionário global
+static void dw_encode_geography(DataWarehouse *dw, DimGeography *geo_dim) {
+    geo_dim->country_code = string_dict_intern(dw->dictionary, geo_dim->country);
+    geo_dim->subregion_code = string_dict_intern(dw->dictionary, geo_dim->subregion);
+    geo_dim->region_code = string_dict_intern(dw->dictionary, geo_dim->region);
+}
+
+static void dw_encode_disaster_type(DataWarehouse *dw, DimDisasterType *type_dim) {
+    type_dim->disaster_group_code = string_dict_intern(dw->dictionary, type_dim->disaster_group);
+    type_dim->disaster_subgroup_code = string_dict_intern(dw->dictionary, type_dim->disaster_subgroup);
+    type_dim->disaster_type_code = string_dict_intern(dw->dictionary, type_dim->disaster_type);
+    type_dim->disaster_subtype_code = string_dict_intern(dw->dictionary, type_dim->disaster_subtype);
+}
+
+// Aloca tabela chave -> linha com todas as posições marcadas como inexistentes
+static int* dw_create_key_table(int capacity) {
+    int *table = malloc((capacity + 1) * sizeof(int));
+    if (!table) return NULL;
+    for (int i = 0; i <= capacity; i++) {
+        table[i] = -1;
+    }
+    return table;
+}
+
+static void dw_register_key(int *table, int capacity, int key, int row) {
+    if (key >= 1 && key <= capacity && table[key] == -1) {
+        table[key] = row;
+    }
+}
+
+// Reconstrói as tabelas hash, de deslocamento e os códigos do dicionário a
+// partir das dimensões (usado após carregar arquivos) e restaura as próximas
+// chaves primárias
+static void dw_rebuild_lookup_indexes(DataWarehouse *dw) {
+    memset(dw->time_hash, 0, dw->time_hash_size * sizeof(int));
+    memset(dw->geography_hash, 0, dw->geography_hash_size * sizeof(int));
+    memset(dw->disaster_type_hash, 0, dw->disaster_type_hash_size * sizeof(int));
+    for (int i = 0; i <= dw->time_capacity; i++) dw->time_row_by_key[i] = -1;
+    for (int i = 0; i <= dw->geography_capacity; i++) dw->geography_row_by_key[i] = -1;
+    for (int i = 0; i <= dw->disaster_type_capacity; i++) dw->disaster_type_row_by_key[i] = -1;
+
+    dw->next_time_key = 1;
+    for (int i = 0; i < dw->time_count; i++) {
+        int key = dw->dim_time[i].time_key;
+        dw_hash_insert_time(dw, i);
+        dw_register_key(dw->time_row_by_key, dw->time_capacity, key, i);
+        if (key >= dw->next_time_key) dw->next_time_key = key + 1;
+    }
+
+    dw->next_geography_key = 1;
+    for (int i = 0; i < dw->geography_count; i++) {
+        int key = dw->dim_geography[i].geography_key;
+        dw_encode_geography(dw, &dw->dim_geography[i]);
+        dw_hash_insert_geography(dw, i);
+        dw_register_key(dw->geography_row_by_key, dw->geography_capacity, key, i);
+        if (key >= dw->next_geography_key) dw->next_geography_key = key + 1;
+    }
+
+    dw->next_disaster_type_key = 1;
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        int key = dw->dim_disaster_type[i].disaster_type_key;
+        dw_encode_disaster_type(dw, &dw->dim_disaster_type[i]);
+        dw_hash_insert_disaster_type(dw, i);
+        dw_register_key(dw->disaster_type_row_by_key, dw->disaster_type_capacity, key, i);
+        if (key >= dw->next_disaster_type_key) dw->next_disaster_type_key = key + 1;
+    }
+
+    dw->next_fact_id = 1;
+    for (int i = 0; i < dw->fact_count; i++) {
+        if (dw->fact_table[i].fact_id >= dw->next_fact_id) {
+            dw->next_fact_id = dw->fact_table[i].fact_id + 1;
+        }
+    }
+}
+
 // =============================================================================
 // FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
 // =============================================================================
 
 DataWarehouse* dw_create() {
-    DataWarehouse *dw = malloc(sizeof(DataWarehouse));
+    DataWarehouse *dw = calloc(1, sizeof(DataWarehouse));
     if (!dw) return NULL;
 
     // Inicializa capacidades
@@ -27,8 +178,27 @@ DataWarehouse* dw_create() {
     dw->dim_disaster_type = malloc(dw->disaster_type_capacity * sizeof(DimDisasterType));
     dw->fact_table = malloc(dw->fact_capacity * sizeof(DisasterFact));
 
+    // Tabelas hash com pelo menos o dobro da capacidade (fator de carga <= 0.5)
+    dw->time_hash_size = dw_hash_table_size(dw->time_capacity);
+    dw->geography_hash_size = dw_hash_table_size(dw->geography_capacity);
+    dw->disaster_type_hash_size = dw_hash_table_size(dw->disaster_type_capacity);
+    dw->time_hash = calloc(dw->time_hash_size, sizeof(int));
+    dw->geography_hash = calloc(dw->geography_hash_size, sizeof(int));
+    dw->disaster_type_hash = calloc(dw->disaster_type_hash_size, sizeof(int));
+
+    // Dicionário de strings compartilhado pelas dimensões
+    dw->dictionary = string_dict_create(1024);
+
+    // Tabelas de deslocamento indexadas pela chave substituta
+    dw->time_row_by_key = dw_create_key_table(dw->time_capacity);
+    dw->geography_row_by_key = dw_create_key_table(dw->geography_capacity);
+    dw->disaster_type_row_by_key = dw_create_key_table(dw->disaster_type_capacity);
+
     if (!dw->dim_time || !dw->dim_geography || !dw->dim_disaster_type ||
-        !dw->fact_table) {
+        !dw->fact_table || !dw->time_hash || !dw->geography_hash ||
+        !dw->disaster_type_hash || !dw->time_row_by_key ||
+        !dw->geography_row_by_key || !dw->disaster_type_row_by_key ||
+        !dw->dictionary) {
         dw_destroy(dw);
         return NULL;
     }
@@ -45,6 +215,12 @@ DataWarehouse* dw_create() {
     dw->next_disaster_type_key = 1;
     dw->next_fact_id = 1;
 
+    // Armazenamento colunar é mantido junto com a tabela fato
+    if (!dw_build_columns(dw)) {
+        dw_destroy(dw);
+        return NULL;
+    }
+
     return dw;
 }
 
@@ -55,9 +231,79 @@ void dw_destroy(DataWarehouse *dw) {
     free(dw->dim_geography);
     free(dw->dim_disaster_type);
     free(dw->fact_table);
+    free(dw->time_hash);
+    free(dw->geography_hash);
+    free(dw->disaster_type_hash);
+    free(dw->time_row_by_key);
+    free(dw->geography_row_by_key);
+    free(dw->disaster_type_row_by_key);
+    dw_drop_columns(dw);
+    string_dict_destroy(dw->dictionary);
     free(dw);
 }
 
+// =============================================================================
+// ARMAZENAMENTO COLUNAR DA TABELA FATO
+// =============================================================================
+
+// Copia o fato da linha informada para as colunas, resolvendo o ano
+static void dw_columns_store(DataWarehouse *dw, int row) {
+    FactColumns *columns = dw->columns;
+    DisasterFact *fact = &dw->fact_table[row];
+    DimTime *time_dim = dw_get_time(dw, fact->time_key);
+
+    columns->start_year[row] = time_dim ? time_dim->start_year : 0;
+    columns->geography_key[row] = dw_get_geography(dw, fact->geography_key) ? fact->geography_key : 0;
+    columns->disaster_type_key[row] = dw_get_disaster_type(dw, fact->disaster_type_key) ? fact->disaster_type_key : 0;
+    columns->total_deaths[row] = fact->total_deaths;
+    columns->total_affected[row] = fact->total_affected;
+    columns->total_damage[row] = fact->total_damage;
+}
+
+void dw_drop_columns(DataWarehouse *dw) {
+    if (!dw || !dw->columns) return;
+
+    free(dw->columns->start_year);
+    free(dw->columns->geography_key);
+    free(dw->columns->disaster_type_key);
+    free(dw->columns->total_deaths);
+    free(dw->columns->total_affected);
+    free(dw->columns->total_damage);
+    free(dw->columns);
+    dw->columns = NULL;
+}
+
+int dw_build_columns(DataWarehouse *dw) {
+    if (!dw) return 0;
+
+    if (!dw->columns) {
+        FactColumns *columns = calloc(1, sizeof(FactColumns));
+        if (!columns) return 0;
+
+        columns->capacity = dw->fact_capacity;
+        columns->start_year = malloc(columns->capacity * sizeof(int));
+        columns->geography_key = malloc(columns->capacity * sizeof(int));
+        columns->disaster_type_key = malloc(columns->capacity * sizeof(int));
+        columns->total_deaths = malloc(columns->capacity * sizeof(int));
+        columns->total_affected = malloc(columns->capacity * sizeof(long long));
+        columns->total_damage = malloc(columns->capacity * sizeof(long long));
+        dw->columns = columns;
+
+        if (!columns->start_year || !columns->geography_key || !columns->disaster_type_key ||
+            !columns->total_deaths || !columns->total_affected || !columns->total_damage) {
+            dw_drop_columns(dw);
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < dw->fact_count; i++) {
+        dw_columns_store(dw, i);
+    }
+    dw->columns->count = dw->fact_count;
+
+    return 1;
+}
+
 // =============================================================================
 // FUNÇÕES DE INSERÇÃO NAS DIMENSÕES
 // =============================================================================
@@ -80,6 +326,8 @@ int dw_insert_time_dimension(DataWarehouse *dw, int start_year, int start_month,
     snprintf(time_dim->end_date_str, sizeof(time_dim->end_date_str),
              "%04d-%02d-%02d", end_year, end_month, end_day);
 
+    dw_hash_insert_time(dw, dw->time_count);
+    dw_register_key(dw->time_row_by_key, dw->time_capacity, time_dim->time_key, dw->time_count);
     dw->time_count++;
     return time_dim->time_key;
 }
@@ -93,7 +341,13 @@ int dw_insert_geography_dimension(DataWarehouse *dw, const char *country,
     strncpy(geo_dim->country, country ? country : "", sizeof(geo_dim->country) - 1);
     strncpy(geo_dim->subregion, subregion ? subregion : "", sizeof(geo_dim->subregion) - 1);
     strncpy(geo_dim->region, region ? region : "", sizeof(geo_dim->region) - 1);
+    geo_dim->country[sizeof(geo_dim->country) - 1] = '\0';
+    geo_dim->subregion[sizeof(geo_dim->subregion) - 1] = '\0';
+    geo_dim->region[sizeof(geo_dim->region) - 1] = '\0';
+    dw_encode_geography(dw, geo_dim);
 
+    dw_hash_insert_geography(dw, dw->geography_count);
+    dw_register_key(dw->geography_row_by_key, dw->geography_capacity, geo_dim->geography_key, dw->geography_count);
     dw->geography_count++;
     return geo_dim->geography_key;
 }
@@ -109,7 +363,14 @@ int dw_insert_disaster_type_dimension(DataWarehouse *dw, const char *disaster_gr
     strncpy(type_dim->disaster_subgroup, disaster_subgroup ? disaster_subgroup : "", sizeof(type_dim->disaster_subgroup) - 1);
     strncpy(type_dim->disaster_type, disaster_type ? disaster_type : "", sizeof(type_dim->disaster_type) - 1);
     strncpy(type_dim->disaster_subtype, disaster_subtype ? disaster_subtype : "", sizeof(type_dim->disaster_subtype) - 1);
-
+    type_dim->disaster_group[sizeof(type_dim->disaster_group) - 1] = '\0';
+    type_dim->disaster_subgroup[sizeof(type_dim->disaster_subgroup) - 1] = '\0';
+    type_dim->disaster_type[sizeof(type_dim->disaster_type) - 1] = '\0';
+    type_dim->disaster_subtype[sizeof(type_dim->disaster_subtype) - 1] = '\0';
+    dw_encode_disaster_type(dw, type_dim);
+
+    dw_hash_insert_disaster_type(dw, dw->disaster_type_count);
+    dw_register_key(dw->disaster_type_row_by_key, dw->disaster_type_capacity, type_dim->disaster_type_key, dw->disaster_type_count);
     dw->disaster_type_count++;
     return type_dim->disaster_type_key;
 }
@@ -132,6 +393,11 @@ int dw_insert_fact(DataWarehouse *dw, int time_key, int geography_key,
     fact->total_affected = total_affected;
     fact->total_damage = total_damage;
 
+    if (dw->columns) {
+        dw_columns_store(dw, dw->fact_count);
+        dw->columns->count = dw->fact_count + 1;
+    }
+
     dw->fact_count++;
     return fact->fact_id;
 }
@@ -143,12 +409,17 @@ int dw_insert_fact(DataWarehouse *dw, int time_key, int geography_key,
 int dw_find_time_key(DataWarehouse *dw, int year, int month, int day) {
     if (!dw) return -1;
 
-    for (int i = 0; i < dw->time_count; i++) {
-        if (dw->dim_time[i].start_year == year &&
-            dw->dim_time[i].start_month == month &&
-            dw->dim_time[i].start_day == day) {
-            return dw->dim_time[i].time_key;
+    unsigned int mask = dw->time_hash_size - 1;
+    unsigned int slot = dw_hash_date(year, month, day) & mask;
+
+    while (dw->time_hash[slot]) {
+        DimTime *time_dim = &dw->dim_time[dw->time_hash[slot] - 1];
+        if (time_dim->start_year == year &&
+            time_dim->start_month == month &&
+            time_dim->start_day == day) {
+            return time_dim->time_key;
         }
+        slot = (slot + 1) & mask;
     }
     return -1;
 }
@@ -156,10 +427,19 @@ int dw_find_time_key(DataWarehouse *dw, int year, int month, int day) {
 int dw_find_geography_key(DataWarehouse *dw, const char *country) {
     if (!dw || !country) return -1;
 
-    for (int i = 0; i < dw->geography_count; i++) {
-        if (strcmp(dw->dim_geography[i].country, country) == 0) {
-            return dw->dim_geography[i].geography_key;
+    // País ausente do dicionário não tem linha na dimensão
+    int country_code = string_dict_lookup(dw->dictionary, country);
+    if (country_code < 0) return -1;
+
+    unsigned int mask = dw->geography_hash_size - 1;
+    unsigned int slot = dw_hash_text(country) & mask;
+
+    while (dw->geography_hash[slot]) {
+        DimGeography *geo_dim = &dw->dim_geography[dw->geography_hash[slot] - 1];
+        if (geo_dim->country_code == country_code) {
+            return geo_dim->geography_key;
         }
+        slot = (slot + 1) & mask;
     }
     return -1;
 }
@@ -167,14 +447,44 @@ int dw_find_geography_key(DataWarehouse *dw, const char *country) {
 int dw_find_disaster_type_key(DataWarehouse *dw, const char *disaster_type) {
     if (!dw || !disaster_type) return -1;
 
-    for (int i = 0; i < dw->disaster_type_count; i++) {
-        if (strcmp(dw->dim_disaster_type[i].disaster_type, disaster_type) == 0) {
-            return dw->dim_disaster_type[i].disaster_type_key;
+    int type_code = string_dict_lookup(dw->dictionary, disaster_type);
+    if (type_code < 0) return -1;
+
+    unsigned int mask = dw->disaster_type_hash_size - 1;
+    unsigned int slot = dw_hash_text(disaster_type) & mask;
+
+    while (dw->disaster_type_hash[slot]) {
+        DimDisasterType *type_dim = &dw->dim_disaster_type[dw->disaster_type_hash[slot] - 1];
+        if (type_dim->disaster_type_code == type_code) {
+            return type_dim->disaster_type_key;
         }
+        slot = (slot + 1) & mask;
     }
     return -1;
 }
 
+// =============================================================================
+// ACESSO ÀS DIMENSÕES PELA CHAVE SUBSTITUTA
+// =============================================================================
+
+DimTime* dw_get_time(DataWarehouse *dw, int time_key) {
+    if (!dw || time_key < 1 || time_key > dw->time_capacity) return NULL;
+    int row = dw->time_row_by_key[time_key];
+    return row >= 0 ? &dw->dim_time[row] : NULL;
+}
+
+DimGeography* dw_get_geography(DataWarehouse *dw, int geography_key) {
+    if (!dw || geography_key < 1 || geography_key > dw->geography_capacity) return NULL;
+    int row = dw->geography_row_by_key[geography_key];
+    return row >= 0 ? &dw->dim_geography[row] : NULL;
+}
+
+DimDisasterType* dw_get_disaster_type(DataWarehouse *dw, int disaster_type_key) {
+    if (!dw || disaster_type_key < 1 || disaster_type_key > dw->disaster_type_capacity) return NULL;
+    int row = dw->disaster_type_row_by_key[disaster_type_key];
+    return row >= 0 ? &dw->dim_disaster_type[row] : NULL;
+}
+
 // =============================================================================
 // FUNÇÕES DE CONSULTA OLAP
 // =============================================================================
@@ -193,15 +503,12 @@ void dw_query_by_year(DataWarehouse *dw, int year) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão tempo
-        for (int j = 0; j < dw->time_count; j++) {
-            if (dw->dim_time[j].time_key == fact->time_key &&
-                dw->dim_time[j].start_year == year) {
-                count++;
-                total_deaths += fact->total_deaths;
-                total_affected += fact->total_affected;
-                total_damage += fact->total_damage;
-                break;
-            }
+        DimTime *time_dim = dw_get_time(dw, fact->time_key);
+        if (time_dim && time_dim->start_year == year) {
+            count++;
+            total_deaths += fact->total_deaths;
+            total_affected += fact->total_affected;
+            total_damage += fact->total_damage;
         }
     }
 
@@ -216,6 +523,9 @@ void dw_query_by_country(DataWarehouse *dw, const char *country) {
 
     printf("Consultando desastres para %s...\n", country);
 
+    // Resolve o país uma única vez; o laço compara apenas códigos
+    int country_code = string_dict_lookup(dw->dictionary, country);
+
     int count = 0;
     int total_deaths = 0;
     long long total_affected = 0;
@@ -225,15 +535,12 @@ void dw_query_by_country(DataWarehouse *dw, const char *country) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão geografia
-        for (int j = 0; j < dw->geography_count; j++) {
-            if (dw->dim_geography[j].geography_key == fact->geography_key &&
-                strcmp(dw->dim_geography[j].country, country) == 0) {
-                count++;
-                total_deaths += fact->total_deaths;
-                total_affected += fact->total_affected;
-                total_damage += fact->total_damage;
-                break;
-            }
+        DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
+        if (geo_dim && geo_dim->country_code == country_code) {
+            count++;
+            total_deaths += fact->total_deaths;
+            total_affected += fact->total_affected;
+            total_damage += fact->total_damage;
         }
     }
 
@@ -248,6 +555,8 @@ void dw_query_by_disaster_type(DataWarehouse *dw, const char *disaster_type) {
 
     printf("Consultando desastres do tipo %s...\n", disaster_type);
 
+    int type_code = string_dict_lookup(dw->dictionary, disaster_type);
+
     int count = 0;
     int total_deaths = 0;
     long long total_affected = 0;
@@ -257,15 +566,12 @@ void dw_query_by_disaster_type(DataWarehouse *dw, const char *disaster_type) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão tipo de desastre
-        for (int j = 0; j < dw->disaster_type_count; j++) {
-            if (dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key &&
-                strcmp(dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                count++;
-                total_deaths += fact->total_deaths;
-                total_affected += fact->total_affected;
-                total_damage += fact->total_damage;
-                break;
-            }
+        DimDisasterType *type_dim = dw_get_disaster_type(dw, fact->disaster_type_key);
+        if (type_dim && type_dim->disaster_type_code == type_code) {
+            count++;
+            total_deaths += fact->total_deaths;
+            total_affected += fact->total_affected;
+            total_damage += fact->total_damage;
         }
     }
 
@@ -280,6 +586,8 @@ void dw_query_summary_by_year_country(DataWarehouse *dw, int year, const char *c
 
     printf("Consultando desastres em %s durante %d...\n", country, year);
 
+    int country_code = string_dict_lookup(dw->dictionary, country);
+
     int count = 0;
     int total_deaths = 0;
     long long total_affected = 0;
@@ -288,27 +596,13 @@ void dw_query_summary_by_year_country(DataWarehouse *dw, int year, const char *c
     for (int i = 0; i < dw->fact_count; i++) {
         DisasterFact *fact = &dw->fact_table[i];
 
-        // Busca dimensão tempo
-        DimTime *time_dim = NULL;
-        for (int j = 0; j < dw->time_count; j++) {
-            if (dw->dim_time[j].time_key == fact->time_key) {
-                time_dim = &dw->dim_time[j];
-                break;
-            }
-        }
-
-        // Busca dimensão geografia
-        DimGeography *geo_dim = NULL;
-        for (int j = 0; j < dw->geography_count; j++) {
-            if (dw->dim_geography[j].geography_key == fact->geography_key) {
-                geo_dim = &dw->dim_geography[j];
-                break;
-            }
-        }
+        // Busca dimensões tempo e geografia
+        DimTime *time_dim = dw_get_time(dw, fact->time_key);
+        DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
 
         if (time_dim && geo_dim &&
             time_dim->start_year == year &&
-            strcmp(geo_dim->country, country) == 0) {
+            geo_dim->country_code == country_code) {
             count++;
             total_deaths += fact->total_deaths;
             total_affected += fact->total_affected;
@@ -335,12 +629,9 @@ long long dw_total_damage_by_year(DataWarehouse *dw, int year) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão tempo
-        for (int j = 0; j < dw->time_count; j++) {
-            if (dw->dim_time[j].time_key == fact->time_key &&
-                dw->dim_time[j].start_year == year) {
-                total_damage += fact->total_damage;
-                break;
-            }
+        DimTime *time_dim = dw_get_time(dw, fact->time_key);
+        if (time_dim && time_dim->start_year == year) {
+            total_damage += fact->total_damage;
         }
     }
 
@@ -351,17 +642,15 @@ long long dw_total_affected_by_country(DataWarehouse *dw, const char *country) {
     if (!dw || !country) return 0;
 
     long long total_affected = 0;
+    int country_code = string_dict_lookup(dw->dictionary, country);
 
     for (int i = 0; i < dw->fact_count; i++) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão geografia
-        for (int j = 0; j < dw->geography_count; j++) {
-            if (dw->dim_geography[j].geography_key == fact->geography_key &&
-                strcmp(dw->dim_geography[j].country, country) == 0) {
-                total_affected += fact->total_affected;
-                break;
-            }
+        DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
+        if (geo_dim && geo_dim->country_code == country_code) {
+            total_affected += fact->total_affected;
         }
     }
 
@@ -372,17 +661,15 @@ int dw_total_deaths_by_disaster_type(DataWarehouse *dw, const char *disaster_typ
     if (!dw || !disaster_type) return 0;
 
     int total_deaths = 0;
+    int type_code = string_dict_lookup(dw->dictionary, disaster_type);
 
     for (int i = 0; i < dw->fact_count; i++) {
         DisasterFact *fact = &dw->fact_table[i];
 
         // Busca dimensão tipo de desastre
-        for (int j = 0; j < dw->disaster_type_count; j++) {
-            if (dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key &&
-                strcmp(dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                total_deaths += fact->total_deaths;
-                break;
-            }
+        DimDisasterType *type_dim = dw_get_disaster_type(dw, fact->disaster_type_key);
+        if (type_dim && type_dim->disaster_type_code == type_code) {
+            total_deaths += fact->total_deaths;
         }
     }
 
@@ -393,6 +680,104 @@ int dw_total_deaths_by_disaster_type(DataWarehouse *dw, const char *disaster_typ
 // FUNÇÕES DE PERSISTÊNCIA
 // =============================================================================
 
+// Registros gravados em disco para as dimensões com strings. Mantêm o layout
+// original das structs (sem os códigos do dicionário, que são reconstruídos na
+// carga), de forma que arquivos antigos continuem legíveis.
+typedef struct {
+    int geography_key;
+    char country[50];
+    char subregion[50];
+    char region[50];
+} GeographyRecord;
+
+typedef struct {
+    int disaster_type_key;
+    char disaster_group[50];
+    char disaster_subgroup[50];
+    char disaster_type[50];
+    char disaster_subtype[50];
+} DisasterTypeRecord;
+
+static int dw_write_geography(FILE *file, DataWarehouse *dw) {
+    if (fwrite(&dw->geography_count, sizeof(int), 1, file) != 1) return 0;
+    for (int i = 0; i < dw->geography_count; i++) {
+        DimGeography *geo = &dw->dim_geography[i];
+        GeographyRecord record;
+        memset(&record, 0, sizeof(record));
+        record.geography_key = geo->geography_key;
+        memcpy(record.country, geo->country, sizeof(record.country));
+        memcpy(record.subregion, geo->subregion, sizeof(record.subregion));
+        memcpy(record.region, geo->region, sizeof(record.region));
+        if (fwrite(&record, sizeof(record), 1, file) != 1) return 0;
+    }
+    return 1;
+}
+
+static int dw_write_disaster_types(FILE *file, DataWarehouse *dw) {
+    if (fwrite(&dw->disaster_type_count, sizeof(int), 1, file) != 1) return 0;
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        DimDisasterType *type = &dw->dim_disaster_type[i];
+        DisasterTypeRecord record;
+        memset(&record, 0, sizeof(record));
+        record.disaster_type_key = type->disaster_type_key;
+        memcpy(record.disaster_group, type->disaster_group, sizeof(record.disaster_group));
+        memcpy(record.disaster_subgroup, type->disaster_subgroup, sizeof(record.disaster_subgroup));
+        memcpy(record.disaster_type, type->disaster_type, sizeof(record.disaster_type));
+        memcpy(record.disaster_subtype, type->disaster_subtype, sizeof(record.disaster_subtype));
+        if (fwrite(&record, sizeof(record), 1, file) != 1) return 0;
+    }
+    return 1;
+}
+
+// Lê o contador de registros e valida contra a capacidade da tabela
+static int dw_read_count(FILE *file, int capacity, int *count) {
+    if (fread(count, sizeof(int), 1, file) != 1) return 0;
+    return *count >= 0 && *count <= capacity;
+}
+
+static int dw_read_geography(FILE *file, DataWarehouse *dw) {
+    if (!dw_read_count(file, dw->geography_capacity, &dw->geography_count)) return 0;
+    for (int i = 0; i < dw->geography_count; i++) {
+        DimGeography *geo = &dw->dim_geography[i];
+        GeographyRecord record;
+        if (fread(&record, sizeof(record), 1, file) != 1) return 0;
+        memset(geo, 0, sizeof(*geo));
+        geo->geography_key = record.geography_key;
+        memcpy(geo->country, record.country, sizeof(geo->country));
+        memcpy(geo->subregion, record.subregion, sizeof(geo->subregion));
+        memcpy(geo->region, record.region, sizeof(geo->region));
+        geo->country[sizeof(geo->country) - 1] = '\0';
+        geo->subregion[sizeof(geo->subregion) - 1] = '\0';
+        geo->region[sizeof(geo->region) - 1] = '\0';
+    }
+    return 1;
+}
+
+static int dw_read_disaster_types(FILE *file, DataWarehouse *dw) {
+    if (!dw_read_count(file, dw->disaster_type_capacity, &dw->disaster_type_count)) return 0;
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        DimDisasterType *type = &dw->dim_disaster_type[i];
+        DisasterTypeRecord record;
+        if (fread(&record, sizeof(record), 1, file) != 1) return 0;
+        memset(type, 0, sizeof(*type));
+        type->disaster_type_key = record.disaster_type_key;
+        memcpy(type->disaster_group, record.disaster_group, sizeof(type->disaster_group));
+        memcpy(type->disaster_subgroup, record.disaster_subgroup, sizeof(type->disaster_subgroup));
+        memcpy(type->disaster_type, record.disaster_type, sizeof(type->disaster_type));
+        memcpy(type->disaster_subtype, record.disaster_subtype, sizeof(type->disaster_subtype));
+        type->disaster_group[sizeof(type->disaster_group) - 1] = '\0';
+        type->disaster_subgroup[sizeof(type->disaster_subgroup) - 1] = '\0';
+        type->disaster_type[sizeof(type->disaster_type) - 1] = '\0';
+        type->disaster_subtype[sizeof(type->disaster_subtype) - 1] = '\0';
+    }
+    return 1;
+}
+
+// Verifica se o arquivo terminou exatamente após os registros esperados
+static int dw_at_end_of_file(FILE *file) {
+    return fgetc(file) == EOF;
+}
+
 int dw_save_to_files(DataWarehouse *dw, const char *base_filename) {
     if (!dw || !base_filename) return 0;
 
@@ -411,16 +796,20 @@ int dw_save_to_files(DataWarehouse *dw, const char *base_filename) {
     snprintf(filename, sizeof(filename), "%s_geography.dat", base_filename);
     file = fopen(filename, "wb");
     if (!file) return 0;
-    fwrite(&dw->geography_count, sizeof(int), 1, file);
-    fwrite(dw->dim_geography, sizeof(DimGeography), dw->geography_count, file);
+    if (!dw_write_geography(file, dw)) {
+        fclose(file);
+        return 0;
+    }
     fclose(file);
 
     // Salva dimensão tipo de desastre
     snprintf(filename, sizeof(filename), "%s_disaster_type.dat", base_filename);
     file = fopen(filename, "wb");
     if (!file) return 0;
-    fwrite(&dw->disaster_type_count, sizeof(int), 1, file);
-    fwrite(dw->dim_disaster_type, sizeof(DimDisasterType), dw->disaster_type_count, file);
+    if (!dw_write_disaster_types(file, dw)) {
+        fclose(file);
+        return 0;
+    }
     fclose(file);
 
     // Salva tabela fato
@@ -451,9 +840,15 @@ DataWarehouse* dw_load_from_files(const char *base_filename) {
         dw_destroy(dw);
         return NULL;
     }
-    fread(&dw->time_count, sizeof(int), 1, file);
-    fread(dw->dim_time, sizeof(DimTime), dw->time_count, file);
+    int ok = dw_read_count(file, dw->time_capacity, &dw->time_count) &&
+             fread(dw->dim_time, sizeof(DimTime), dw->time_count, file) == (size_t)dw->time_count &&
+             dw_at_end_of_file(file);
     fclose(file);
+    if (!ok) {
+        printf("Arquivo inválido ou corrompido: %s\n", filename);
+        dw_destroy(dw);
+        return NULL;
+    }
 
     // Carrega dimensão geografia
     snprintf(filename, sizeof(filename), "%s_geography.dat", base_filename);
@@ -462,9 +857,13 @@ DataWarehouse* dw_load_from_files(const char *base_filename) {
         dw_destroy(dw);
         return NULL;
     }
-    fread(&dw->geography_count, sizeof(int), 1, file);
-    fread(dw->dim_geography, sizeof(DimGeography), dw->geography_count, file);
+    ok = dw_read_geography(file, dw) && dw_at_end_of_file(file);
     fclose(file);
+    if (!ok) {
+        printf("Arquivo inválido ou corrompido: %s\n", filename);
+        dw_destroy(dw);
+        return NULL;
+    }
 
     // Carrega dimensão tipo de desastre
     snprintf(filename, sizeof(filename), "%s_disaster_type.dat", base_filename);
@@ -473,9 +872,13 @@ DataWarehouse* dw_load_from_files(const char *base_filename) {
         dw_destroy(dw);
         return NULL;
     }
-    fread(&dw->disaster_type_count, sizeof(int), 1, file);
-    fread(dw->dim_disaster_type, sizeof(DimDisasterType), dw->disaster_type_count, file);
+    ok = dw_read_disaster_types(file, dw) && dw_at_end_of_file(file);
     fclose(file);
+    if (!ok) {
+        printf("Arquivo inválido ou corrompido: %s\n", filename);
+        dw_destroy(dw);
+        return NULL;
+    }
 
     // Carrega tabela fato
     snprintf(filename, sizeof(filename), "%s_fact.dat", base_filename);
@@ -484,9 +887,24 @@ DataWarehouse* dw_load_from_files(const char *base_filename) {
         dw_destroy(dw);
         return NULL;
     }
-    fread(&dw->fact_count, sizeof(int), 1, file);
-    fread(dw->fact_table, sizeof(DisasterFact), dw->fact_count, file);
+    ok = dw_read_count(file, dw->fact_capacity, &dw->fact_count) &&
+         fread(dw->fact_table, sizeof(DisasterFact), dw->fact_count, file) == (size_t)dw->fact_count &&
+         dw_at_end_of_file(file);
     fclose(file);
+    if (!ok) {
+        printf("Arquivo inválido ou corrompido: %s\n", filename);
+        dw_destroy(dw);
+        return NULL;
+    }
+
+    // Tabelas hash e de deslocamento não são persistidas; reconstruir
+    dw_rebuild_lookup_indexes(dw);
+
+    // Colunas dependem das tabelas de deslocamento para resolver o ano
+    if (dw->columns && !dw_build_columns(dw)) {
+        dw_destroy(dw);
+        return NULL;
+    }
 
     return dw;
 }
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "string_dictionary.h"
 
 // =============================================================================
 // TABELA FATO
@@ -43,6 +44,11 @@ typedef struct {
     char country[50];
     char subregion[50];
     char region[50];
+
+    // Códigos no dicionário de strings (comparação por inteiros nos filtros)
+    int country_code;
+    int subregion_code;
+    int region_code;
 } DimGeography;
 
 // Dimensão Tipo de Desastre
@@ -52,6 +58,12 @@ typedef struct {
     char disaster_subgroup[50];
     char disaster_type[50];
     char disaster_subtype[50];
+
+    // Códigos no dicionário de strings (comparação por inteiros nos filtros)
+    int disaster_group_code;
+    int disaster_subgroup_code;
+    int disaster_type_code;
+    int disaster_subtype_code;
 } DimDisasterType;
 
 // Dimensão Evento
@@ -87,6 +99,25 @@ typedef struct {
     char disaster_group[50];
 } DisasterTypeIndex;
 
+// =============================================================================
+// ARMAZENAMENTO COLUNAR DA TABELA FATO
+// =============================================================================
+
+// Cópia da tabela fato em colunas contíguas (structure-of-arrays), com o ano
+// já resolvido da dimensão tempo. A posição i de cada coluna corresponde a
+// fact_table[i]; chaves sem linha de dimensão correspondente são gravadas
+// como 0 (ano 0), de modo que os laços de filtro não precisem de junções.
+typedef struct {
+    int *start_year;
+    int *geography_key;
+    int *disaster_type_key;
+    int *total_deaths;
+    long long *total_affected;
+    long long *total_damage;
+    int count;
+    int capacity;
+} FactColumns;
+
 // =============================================================================
 // ESTRUTURA PRINCIPAL DO DATA WAREHOUSE
 // =============================================================================
@@ -117,6 +148,27 @@ typedef struct {
     int next_disaster_type_key;
     int next_fact_id;
 
+    // Índices hash das chaves naturais (endereçamento aberto).
+    // Cada posição guarda a linha da dimensão + 1; 0 indica posição vazia.
+    int *time_hash;              // (ano, mês, dia) -> linha em dim_time
+    int *geography_hash;         // país -> linha em dim_geography
+    int *disaster_type_hash;     // tipo de desastre -> linha em dim_disaster_type
+    int time_hash_size;
+    int geography_hash_size;
+    int disaster_type_hash_size;
+
+    // Tabelas de deslocamento: chave substituta -> linha da dimensão (-1 se
+    // inexistente). As chaves são densas (1..capacidade), então o acesso é O(1).
+    int *time_row_by_key;
+    int *geography_row_by_key;
+    int *disaster_type_row_by_key;
+
+    // Armazenamento colunar opcional da tabela fato (NULL se desabilitado)
+    FactColumns *columns;
+
+    // Dicionário global das strings das dimensões (país, região, tipo, ...)
+    StringDictionary *dictionary;
+
 } DataWarehouse;
 
 // =============================================================================
@@ -146,6 +198,15 @@ int dw_find_time_key(DataWarehouse *dw, int year, int month, int day);
 int dw_find_geography_key(DataWarehouse *dw, const char *country);
 int dw_find_disaster_type_key(DataWarehouse *dw, const char *disaster_type);
 
+// Acesso O(1) às linhas das dimensões pela chave substituta (NULL se inválida)
+DimTime* dw_get_time(DataWarehouse *dw, int time_key);
+DimGeography* dw_get_geography(DataWarehouse *dw, int geography_key);
+DimDisasterType* dw_get_disaster_type(DataWarehouse *dw, int disaster_type_key);
+
+// Armazenamento colunar: (re)constrói a partir de fact_table ou libera
+int dw_build_columns(DataWarehouse *dw);
+void dw_drop_columns(DataWarehouse *dw);
+
 // Funções de consulta OLAP
 void dw_query_by_year(DataWarehouse *dw, int year);
 void dw_query_by_country(DataWarehouse *dw, const char *country);
@@ -32,15 +32,16 @@
 #define TEXT_COLOR (Color){52, 73, 94, 255}
 #define SLIDER_COLOR (Color){100, 149, 237, 255}
 
-// Estrutura para armazenar dados de desastre
+// Estrutura para armazenar dados de desastre. Os campos textuais guardam
+// códigos do dicionário de strings do data warehouse (ver string_dict_get)
 typedef struct {
-    char disaster_group[50];
-    char disaster_subgroup[50];
-    char disaster_type[50];
-    char disaster_subtype[50];
-    char country[50];
-    char subregion[50];
-    char region[50];
+    int disaster_group_code;
+    int disaster_subgroup_code;
+    int disaster_type_code;
+    int disaster_subtype_code;
+    int country_code;
+    int subregion_code;
+    int region_code;
     int start_year;
     int start_month;
     int start_day;
@@ -55,6 +56,7 @@ typedef struct {
 // Estrutura para estatísticas por país com ordenação
 typedef struct {
     char country[50];
+    int country_code;
     long long total_affected;
     int disaster_count;
     long long total_damage;
@@ -87,8 +89,12 @@ typedef struct {
     char countries[MAX_COUNTRIES][50];
     int country_count;
     char disaster_types[MAX_DISASTER_TYPES][50];
+    int disaster_type_codes[MAX_DISASTER_TYPES];
     int disaster_type_count;
 
+    // Dicionário de strings do data warehouse (códigos dos registros)
+    StringDictionary *dictionary;
+
     // Filtros
     int selected_country;
     int selected_disaster_type;
@@ -123,10 +129,19 @@ typedef struct {
     BPlusTree *sort_bplus_deaths;
 
     // Estatísticas calculadas
+    int total_records_filtered;
     long long total_affected_filtered;
     int total_deaths_filtered;
     long long total_damage_filtered;
 
+    // Países aceitos pelo filtro de texto na última ApplyFilters (-1 em
+    // country_filter_count = sem filtro). Enquanto o slider de anos é
+    // arrastado só os totais são refeitos, pelas somas acumuladas por ano.
+    int *country_filter_codes;
+    int country_filter_count;
+    bool year_summary_ready;
+    bool year_filter_pending;
+
     // Stats por país para gráfico (com ordenação)
     CountryStats country_stats[MAX_COUNTRIES];
     int country_stats_count;
@@ -213,12 +228,11 @@ void BuildCountrySortingIndexes(DisasterGUI *gui) {
     for (int i = 0; i < gui->country_stats_count; i++) {
         CountryStats *stats = &gui->country_stats[i];
 
-        // Para evitar problemas com valores muito grandes, dividir por 1000
         if (gui->sort_bplus_affected) {
-            bplus_insert(gui->sort_bplus_affected, (int)(stats->total_affected / 1000), i);
+            bplus_insert(gui->sort_bplus_affected, stats->total_affected, i);
         }
         if (gui->sort_bplus_damage) {
-            bplus_insert(gui->sort_bplus_damage, (int)(stats->total_damage / 1000), i);
+            bplus_insert(gui->sort_bplus_damage, stats->total_damage, i);
         }
         if (gui->sort_bplus_deaths) {
             bplus_insert(gui->sort_bplus_deaths, stats->total_deaths, i);
@@ -277,10 +291,15 @@ int compare_disasters_by_deaths_desc(const void *a, const void *b) {
     return rec_b->total_deaths - rec_a->total_deaths;
 }
 
+// Dicionário usado pelo comparador por nome (qsort não recebe contexto)
+static const StringDictionary *record_dictionary = NULL;
+
 int compare_disasters_by_country_asc(const void *a, const void *b) {
     DisasterRecord *rec_a = (DisasterRecord *)a;
     DisasterRecord *rec_b = (DisasterRecord *)b;
-    return strcmp(rec_a->country, rec_b->country);
+    if (rec_a->country_code == rec_b->country_code) return 0;
+    return strcmp(string_dict_get(record_dictionary, rec_a->country_code),
+                  string_dict_get(record_dictionary, rec_b->country_code));
 }
 
 // Ordenar tabela de desastres
@@ -405,6 +424,7 @@ void CleanupGUI(DisasterGUI *gui) {
 
     if (gui->disasters) free(gui->disasters);
     if (gui->filtered_disasters) free(gui->filtered_disasters);
+    free(gui->country_filter_codes);
 
     // Limpar árvores de ordenação
     CleanupSortingTrees(gui);
@@ -444,11 +464,11 @@ int InitializeOptimizedSystem(DisasterGUI *gui, DataWarehouse *dw) {
     gui->optimized_dw->dw = dw;
     gui->optimized_dw->indexes->dw = dw;
 
-    // Construir todos os índices
-    printf("Construindo índices para %d registros...\n", dw->fact_count);
+    // Carregar índices salvos (reconstrói e salva se estiverem desatualizados)
+    printf("Carregando índices para %d registros...\n", dw->fact_count);
     clock_t start_time = clock();
 
-    if (index_system_build_all(gui->optimized_dw->indexes) != 1) {
+    if (index_system_load_all(gui->optimized_dw->indexes) != 1) {
         printf("Erro ao construir índices\n");
         optimized_dw_destroy(gui->optimized_dw);
         gui->optimized_dw = NULL;
@@ -477,6 +497,111 @@ int InitializeOptimizedSystem(DisasterGUI *gui, DataWarehouse *dw) {
     return 1;
 }
 
+// Marca os códigos do dicionário cujo texto contém o termo digitado
+// (comparação case-insensitive); indexado pelo código da string
+unsigned char* BuildCountryMatchTable(const StringDictionary *dictionary, const char *input) {
+    int code_count = string_dict_count(dictionary);
+    unsigned char *matches = calloc(code_count > 0 ? code_count : 1, sizeof(unsigned char));
+    if (!matches) return NULL;
+
+    char input_lower[50];
+    strncpy(input_lower, input, sizeof(input_lower) - 1);
+    input_lower[sizeof(input_lower) - 1] = '\0';
+    for (int j = 0; input_lower[j]; j++) {
+        input_lower[j] = tolower(input_lower[j]);
+    }
+
+    for (int code = 0; code < code_count; code++) {
+        char country_lower[50];
+        strncpy(country_lower, string_dict_get(dictionary, code), sizeof(country_lower) - 1);
+        country_lower[sizeof(country_lower) - 1] = '\0';
+
+        for (int j = 0; country_lower[j]; j++) {
+            country_lower[j] = tolower(country_lower[j]);
+        }
+
+        matches[code] = strstr(country_lower, input_lower) != NULL;
+    }
+    return matches;
+}
+
+// Verifica se algum registro tem o país marcado na tabela de correspondência
+// (o dicionário também guarda regiões e tipos, que não contam como país)
+bool CountryMatchTableHasRecords(DisasterGUI *gui, const unsigned char *matches) {
+    int code_count = string_dict_count(gui->dictionary);
+    for (int i = 0; i < gui->disaster_count; i++) {
+        int code = gui->disasters[i].country_code;
+        if (code >= 0 && code < code_count && matches[code]) return true;
+    }
+    return false;
+}
+
+// Código do tipo de desastre selecionado (-1 = todos)
+int SelectedDisasterTypeCode(DisasterGUI *gui) {
+    if (gui->selected_disaster_type > 0 &&
+        gui->selected_disaster_type < gui->disaster_type_count) {
+        return gui->disaster_type_codes[gui->selected_disaster_type];
+    }
+    return -1;
+}
+
+// Guarda os códigos marcados em matches (indexado pelo código do dicionário)
+// como os países do filtro atual. Retorna false se não há tabela ou memória.
+bool SetCountryFilterCodes(DisasterGUI *gui, const unsigned char *matches) {
+    free(gui->country_filter_codes);
+    gui->country_filter_codes = NULL;
+    gui->country_filter_count = -1;
+    if (!matches) return false;
+
+    int code_count = string_dict_count(gui->dictionary);
+    gui->country_filter_codes = malloc((code_count > 0 ? code_count : 1) * sizeof(int));
+    if (!gui->country_filter_codes) return false;
+
+    gui->country_filter_count = 0;
+    for (int code = 0; code < code_count; code++) {
+        if (matches[code]) {
+            gui->country_filter_codes[gui->country_filter_count++] = code;
+        }
+    }
+    return true;
+}
+
+// Atualiza só os totais do painel de estatísticas para o intervalo de anos
+// atual: duas posições das somas acumuladas por país (ou do total geral/tipo),
+// sem percorrer os registros. Retorna false quando a combinação de filtros
+// não é coberta pelas somas; nesse caso é preciso chamar ApplyFilters.
+bool UpdateYearSummary(DisasterGUI *gui) {
+    if (!gui->year_summary_ready || !gui->optimized_dw || !gui->optimized_dw->indexes) return false;
+
+    IndexSystem *indexes = gui->optimized_dw->indexes;
+    int type_code = SelectedDisasterTypeCode(gui);
+    YearRangeTotals totals = {0};
+
+    if (gui->country_filter_count < 0) {
+        if (!index_year_range_totals(indexes, -1, type_code, gui->start_year, gui->end_year, &totals)) {
+            return false;
+        }
+    } else {
+        for (int i = 0; i < gui->country_filter_count; i++) {
+            YearRangeTotals country_totals;
+            if (!index_year_range_totals(indexes, gui->country_filter_codes[i], type_code,
+                                         gui->start_year, gui->end_year, &country_totals)) {
+                return false;
+            }
+            totals.count += country_totals.count;
+            totals.total_deaths += country_totals.total_deaths;
+            totals.total_affected += country_totals.total_affected;
+            totals.total_damage += country_totals.total_damage;
+        }
+    }
+
+    gui->total_records_filtered = totals.count;
+    gui->total_deaths_filtered = (int)totals.total_deaths;
+    gui->total_affected_filtered = totals.total_affected;
+    gui->total_damage_filtered = totals.total_damage;
+    return true;
+}
+
 // Função melhorada para aplicar filtros (com filtro de ano usando B+ Tree)
 void ApplyFilters(DisasterGUI *gui) {
     if (!gui || !gui->disasters) return;
@@ -488,6 +613,13 @@ void ApplyFilters(DisasterGUI *gui) {
     gui->total_deaths_filtered = 0;
     gui->total_damage_filtered = 0;
 
+    // Tipo selecionado resolvido para código uma única vez (-1 = todos)
+    int selected_type_code = SelectedDisasterTypeCode(gui);
+
+    // Países do filtro de texto, resolvidos pelo caminho que produzir o resultado
+    SetCountryFilterCodes(gui, NULL);
+    bool country_codes_ok = strlen(gui->country_input) == 0;
+
     // Usar índices otimizados quando disponível e apropriado
     if (gui->use_optimized_queries && gui->optimized_dw &&
         gui->optimized_dw->indexes && strlen(gui->country_input) > 0) {
@@ -502,9 +634,33 @@ void ApplyFilters(DisasterGUI *gui) {
                                                gui->country_input,
                                                &result_count);
 
+        // Nome parcial ("Chin", "Guine") fica com a busca convencional, que
+        // inclui todos os países que contêm o termo. O país indexado mais
+        // próximo só é usado quando nenhum país contém o termo (ex.: "Brazl").
+        if (!result_ids || result_count == 0) {
+            free(result_ids);
+            result_ids = NULL;
+            result_count = 0;
+
+            unsigned char *substring_matches = BuildCountryMatchTable(gui->dictionary, gui->country_input);
+            if (substring_matches && !CountryMatchTableHasRecords(gui, substring_matches)) {
+                char resolved[50];
+                result_ids = optimized_query_by_country_fuzzy(gui->optimized_dw, gui->country_input,
+                                                              resolved, sizeof(resolved), &result_count);
+                if (result_ids && result_count > 0) {
+                    printf("País '%s' não encontrado, usando '%s'\n", gui->country_input, resolved);
+                }
+            }
+            free(substring_matches);
+        }
+
         if (result_ids && result_count > 0) {
             printf("Consulta otimizada retornou %d resultados\n", result_count);
 
+            // Países dos resultados, sem os filtros de tipo e ano
+            int code_count = string_dict_count(gui->dictionary);
+            unsigned char *country_matches = calloc(code_count > 0 ? code_count : 1, sizeof(unsigned char));
+
             // Aplicar filtros adicionais aos resultados otimizados
             for (int i = 0; i < result_count && gui->filtered_count < MAX_DISASTERS; i++) {
                 int fact_id = result_ids[i];
@@ -514,13 +670,14 @@ void ApplyFilters(DisasterGUI *gui) {
                     DisasterRecord *record = &gui->disasters[fact_id];
                     bool include = true;
 
+                    if (country_matches && record->country_code >= 0 && record->country_code < code_count) {
+                        country_matches[record->country_code] = 1;
+                    }
+
                     // Filtro por tipo de desastre
-                    if (gui->selected_disaster_type > 0 &&
-                        gui->selected_disaster_type < gui->disaster_type_count) {
-                        if (strcmp(record->disaster_type,
-                                 gui->disaster_types[gui->selected_disaster_type]) != 0) {
-                            include = false;
-                        }
+                    if (selected_type_code >= 0 &&
+                        record->disaster_type_code != selected_type_code) {
+                        include = false;
                     }
 
                     // Filtro por ano usando slider duplo
@@ -540,6 +697,8 @@ void ApplyFilters(DisasterGUI *gui) {
             }
 
             free(result_ids);
+            country_codes_ok = SetCountryFilterCodes(gui, country_matches);
+            free(country_matches);
 
             clock_t end_time = clock();
             double query_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
@@ -554,41 +713,30 @@ void ApplyFilters(DisasterGUI *gui) {
     if (!gui->use_optimized_queries || gui->filtered_count == 0) {
         printf("Usando busca convencional\n");
 
+        // Filtro por país (busca parcial): a comparação de texto é feita uma
+        // vez por string do dicionário e os registros consultam o resultado
+        unsigned char *country_matches = NULL;
+        if (strlen(gui->country_input) > 0) {
+            country_matches = BuildCountryMatchTable(gui->dictionary, gui->country_input);
+            country_codes_ok = SetCountryFilterCodes(gui, country_matches);
+        }
+
         for (int i = 0; i < gui->disaster_count; i++) {
             DisasterRecord *record = &gui->disasters[i];
             bool include = true;
 
             // Filtro por país usando input de texto (busca parcial)
             if (strlen(gui->country_input) > 0) {
-                char country_lower[50], input_lower[50];
-
-                // Verificar bounds antes de copiar
-                strncpy(country_lower, record->country, sizeof(country_lower) - 1);
-                country_lower[sizeof(country_lower) - 1] = '\0';
-
-                strncpy(input_lower, gui->country_input, sizeof(input_lower) - 1);
-                input_lower[sizeof(input_lower) - 1] = '\0';
-
-                // Converter para minúsculo para busca case-insensitive
-                for (int j = 0; country_lower[j]; j++) {
-                    country_lower[j] = tolower(country_lower[j]);
-                }
-                for (int j = 0; input_lower[j]; j++) {
-                    input_lower[j] = tolower(input_lower[j]);
-                }
-
-                if (strstr(country_lower, input_lower) == NULL) {
+                if (!country_matches || record->country_code < 0 ||
+                    !country_matches[record->country_code]) {
                     include = false;
                 }
             }
 
             // Filtro por tipo de desastre
-            if (gui->selected_disaster_type > 0 &&
-                gui->selected_disaster_type < gui->disaster_type_count) {
-                if (strcmp(record->disaster_type,
-                         gui->disaster_types[gui->selected_disaster_type]) != 0) {
-                    include = false;
-                }
+            if (selected_type_code >= 0 &&
+                record->disaster_type_code != selected_type_code) {
+                include = false;
             }
 
             // Filtro por ano usando slider duplo
@@ -606,6 +754,8 @@ void ApplyFilters(DisasterGUI *gui) {
             }
         }
 
+        free(country_matches);
+
         clock_t end_time = clock();
         double query_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
         printf("Busca convencional executada em %.4f segundos\n", query_time);
@@ -618,7 +768,7 @@ void ApplyFilters(DisasterGUI *gui) {
 
         int country_idx = -1;
         for (int j = 0; j < gui->country_stats_count; j++) {
-            if (strcmp(gui->country_stats[j].country, record->country) == 0) {
+            if (gui->country_stats[j].country_code == record->country_code) {
                 country_idx = j;
                 break;
             }
@@ -626,8 +776,10 @@ void ApplyFilters(DisasterGUI *gui) {
 
         if (country_idx == -1 && gui->country_stats_count < MAX_COUNTRIES) {
             strncpy(gui->country_stats[gui->country_stats_count].country,
-                   record->country, sizeof(gui->country_stats[0].country) - 1);
+                   string_dict_get(gui->dictionary, record->country_code),
+                   sizeof(gui->country_stats[0].country) - 1);
             gui->country_stats[gui->country_stats_count].country[sizeof(gui->country_stats[0].country) - 1] = '\0';
+            gui->country_stats[gui->country_stats_count].country_code = record->country_code;
             gui->country_stats[gui->country_stats_count].total_affected = record->total_affected;
             gui->country_stats[gui->country_stats_count].total_damage = record->total_damage;
             gui->country_stats[gui->country_stats_count].total_deaths = record->total_deaths;
@@ -645,6 +797,9 @@ void ApplyFilters(DisasterGUI *gui) {
     SortCountryStats(gui, gui->current_sort_type, gui->current_sort_order);
     SortDisasterTable(gui, gui->current_sort_type);
 
+    gui->total_records_filtered = gui->filtered_count;
+    gui->year_summary_ready = country_codes_ok;
+
     printf("Filtros aplicados: %d registros encontrados\n", gui->filtered_count);
 }
 
@@ -704,9 +859,19 @@ void DrawFilterControls(Rectangle bounds, DisasterGUI *gui, bool *filters_change
     DrawText("End Year:", bounds.x + 550, bounds.y + 20, 14, TEXT_COLOR);
     DrawText(TextFormat("%d", gui->end_year), bounds.x + 620, bounds.y + 20, 14, PRIMARY_COLOR);
 
+    // Durante o arraste só os totais acompanham o slider (somas acumuladas
+    // por ano); tabela e gráfico são refeitos quando o botão é solto
     if (DrawDoubleSlider(year_slider_rect, gui->min_year, gui->max_year,
                         &gui->start_year, &gui->end_year,
                         &gui->start_year_slider_active, &gui->end_year_slider_active)) {
+        if (UpdateYearSummary(gui)) {
+            gui->year_filter_pending = true;
+        } else {
+            *filters_changed = true;
+        }
+    }
+    if (gui->year_filter_pending && !IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+        gui->year_filter_pending = false;
         *filters_changed = true;
     }
 
@@ -857,7 +1022,7 @@ void DrawDetailedStatsPanel(Rectangle bounds, DisasterGUI *gui) {
     int line_height = 25;
 
     // Total de registros
-    DrawText(TextFormat("Total Records: %d", gui->filtered_count),
+    DrawText(TextFormat("Total Records: %d", gui->total_records_filtered),
              bounds.x + 20, bounds.y + y_offset, 14, TEXT_COLOR);
     y_offset += line_height;
 
@@ -1107,25 +1272,25 @@ void DrawDataTable(Rectangle bounds, DisasterRecord *records, int count, int *sc
         x_pos = bounds.x + 5;
 
         // Desenhar cada coluna
-        DrawText(record->disaster_group, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->disaster_group_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[0];
 
-        DrawText(record->disaster_subgroup, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->disaster_subgroup_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[1];
 
-        DrawText(record->disaster_type, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->disaster_type_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[2];
 
-        DrawText(record->disaster_subtype, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->disaster_subtype_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[3];
 
-        DrawText(record->country, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->country_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[4];
 
-        DrawText(record->subregion, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->subregion_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[5];
 
-        DrawText(record->region, x_pos, y_pos, 10, TEXT_COLOR);
+        DrawText(string_dict_get(gui->dictionary, record->region_code), x_pos, y_pos, 10, TEXT_COLOR);
         x_pos += col_widths[6];
 
         DrawText(TextFormat("%d", record->start_year), x_pos, y_pos, 10, TEXT_COLOR);
@@ -1306,68 +1471,42 @@ void LoadDataFromStarSchema(DisasterGUI *gui, DataWarehouse *dw) {
 
     printf("Convertendo %d fatos do esquema estrela para GUI...\n", dw->fact_count);
 
+    // Registros guardam códigos; o texto é resolvido no dicionário do DW
+    gui->dictionary = dw->dictionary;
+    record_dictionary = dw->dictionary;
+    int unknown_code = string_dict_intern(dw->dictionary, "Unknown");
+
     // Converte cada fato para formato da GUI
     for (int i = 0; i < dw->fact_count; i++) {
         DisasterFact *fact = &dw->fact_table[i];
         DisasterRecord *record = &gui->disasters[i];
 
-        // Busca informações das dimensões
-        DimTime *time_dim = NULL;
-        DimGeography *geo_dim = NULL;
-        DimDisasterType *type_dim = NULL;
+        // Busca informações das dimensões (acesso direto pela chave)
+        DimTime *time_dim = dw_get_time(dw, fact->time_key);
+        DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
+        DimDisasterType *type_dim = dw_get_disaster_type(dw, fact->disaster_type_key);
 
-        // Encontra dimensão tempo
-        for (int j = 0; j < dw->time_count; j++) {
-            if (dw->dim_time[j].time_key == fact->time_key) {
-                time_dim = &dw->dim_time[j];
-                break;
-            }
-        }
-
-        // Encontra dimensão geografia
-        for (int j = 0; j < dw->geography_count; j++) {
-            if (dw->dim_geography[j].geography_key == fact->geography_key) {
-                geo_dim = &dw->dim_geography[j];
-                break;
-            }
-        }
-
-        // Encontra dimensão tipo de desastre
-        for (int j = 0; j < dw->disaster_type_count; j++) {
-            if (dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                type_dim = &dw->dim_disaster_type[j];
-                break;
-            }
-        }
-
-        // Preenche dados do registro com validação
+        // Preenche os códigos do registro com validação
         if (geo_dim) {
-            strncpy(record->country, geo_dim->country, sizeof(record->country) - 1);
-            record->country[sizeof(record->country) - 1] = '\0';
-            strncpy(record->region, geo_dim->region, sizeof(record->region) - 1);
-            record->region[sizeof(record->region) - 1] = '\0';
-            strncpy(record->subregion, geo_dim->subregion, sizeof(record->subregion) - 1);
-            record->subregion[sizeof(record->subregion) - 1] = '\0';
+            record->country_code = geo_dim->country_code;
+            record->region_code = geo_dim->region_code;
+            record->subregion_code = geo_dim->subregion_code;
         } else {
-            strcpy(record->country, "Unknown");
-            strcpy(record->region, "Unknown");
-            strcpy(record->subregion, "Unknown");
+            record->country_code = unknown_code;
+            record->region_code = unknown_code;
+            record->subregion_code = unknown_code;
         }
 
         if (type_dim) {
-            strncpy(record->disaster_type, type_dim->disaster_type, sizeof(record->disaster_type) - 1);
-            record->disaster_type[sizeof(record->disaster_type) - 1] = '\0';
-            strncpy(record->disaster_group, type_dim->disaster_group, sizeof(record->disaster_group) - 1);
-            record->disaster_group[sizeof(record->disaster_group) - 1] = '\0';
-            strncpy(record->disaster_subgroup, type_dim->disaster_subgroup, sizeof(record->disaster_subgroup) - 1);
-            record->disaster_subgroup[sizeof(record->disaster_subgroup) - 1] = '\0';
-            strncpy(record->disaster_subtype, type_dim->disaster_subtype, sizeof(record->disaster_subtype) - 1);
-            record->disaster_subtype[sizeof(record->disaster_subtype) - 1] = '\0';
+            record->disaster_type_code = type_dim->disaster_type_code;
+            record->disaster_group_code = type_dim->disaster_group_code;
+            record->disaster_subgroup_code = type_dim->disaster_subgroup_code;
+            record->disaster_subtype_code = type_dim->disaster_subtype_code;
         } else {
-            strcpy(record->disaster_type, "Unknown");
-            strcpy(record->disaster_group, "Unknown");
-            strcpy(record->disaster_subgroup, "Unknown");
-            strcpy(record->disaster_subtype, "Unknown");
+            record->disaster_type_code = unknown_code;
+            record->disaster_group_code = unknown_code;
+            record->disaster_subgroup_code = unknown_code;
+            record->disaster_subtype_code = unknown_code;
         }
 
         record->start_year = time_dim ? time_dim->start_year : 0;
@@ -1386,16 +1525,22 @@ void LoadDataFromStarSchema(DisasterGUI *gui, DataWarehouse *dw) {
     gui->country_count = 0;
     strcpy(gui->countries[gui->country_count++], "All Countries");
 
+    // Marca por código os valores já vistos em vez de comparar strings
+    unsigned char *seen = calloc(string_dict_count(dw->dictionary) + 1, sizeof(unsigned char));
+    if (!seen) {
+        printf("Erro ao alocar memória para listas únicas\n");
+        return;
+    }
+
     for (int i = 0; i < gui->disaster_count; i++) {
-        bool found = false;
-        for (int j = 1; j < gui->country_count; j++) {
-            if (strcmp(gui->countries[j], gui->disasters[i].country) == 0) {
-                found = true;
-                break;
-            }
-        }
-        if (!found && gui->country_count < MAX_COUNTRIES) {
-            strcpy(gui->countries[gui->country_count++], gui->disasters[i].country);
+        int code = gui->disasters[i].country_code;
+        if (code < 0 || seen[code]) continue;
+        seen[code] = 1;
+        if (gui->country_count < MAX_COUNTRIES) {
+            strncpy(gui->countries[gui->country_count], string_dict_get(dw->dictionary, code),
+                    sizeof(gui->countries[0]) - 1);
+            gui->countries[gui->country_count][sizeof(gui->countries[0]) - 1] = '\0';
+            gui->country_count++;
         }
     }
 
@@ -1403,20 +1548,23 @@ void LoadDataFromStarSchema(DisasterGUI *gui, DataWarehouse *dw) {
 
     // Extrair tipos de desastre únicos
     gui->disaster_type_count = 0;
+    gui->disaster_type_codes[gui->disaster_type_count] = -1;
     strcpy(gui->disaster_types[gui->disaster_type_count++], "All Types");
+    memset(seen, 0, string_dict_count(dw->dictionary) + 1);
 
     for (int i = 0; i < gui->disaster_count; i++) {
-        bool found = false;
-        for (int j = 1; j < gui->disaster_type_count; j++) {
-            if (strcmp(gui->disaster_types[j], gui->disasters[i].disaster_type) == 0) {
-                found = true;
-                break;
-            }
-        }
-        if (!found && gui->disaster_type_count < MAX_DISASTER_TYPES) {
-            strcpy(gui->disaster_types[gui->disaster_type_count++], gui->disasters[i].disaster_type);
+        int code = gui->disasters[i].disaster_type_code;
+        if (code < 0 || seen[code]) continue;
+        seen[code] = 1;
+        if (gui->disaster_type_count < MAX_DISASTER_TYPES) {
+            strncpy(gui->disaster_types[gui->disaster_type_count], string_dict_get(dw->dictionary, code),
+                    sizeof(gui->disaster_types[0]) - 1);
+            gui->disaster_types[gui->disaster_type_count][sizeof(gui->disaster_types[0]) - 1] = '\0';
+            gui->disaster_type_codes[gui->disaster_type_count] = code;
+            gui->disaster_type_count++;
         }
     }
+    free(seen);
 
     printf("Tipos de desastre únicos extraídos: %d\n", gui->disaster_type_count);
 
@@ -0,0 +1,230 @@
+#include "postings.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// A partir desta razão entre os tamanhos, buscar os valores da lista menor na
+// maior custa menos que percorrer as duas
+#define POSTINGS_GALLOP_RATIO 32
+
+// Primeira posição de list[from..count) com valor >= value. O passo dobra até
+// passar do valor e a busca binária termina no último trecho, então o custo
+// depende da distância percorrida e não do tamanho da lista.
+static int postings_gallop(const int *list, int from, int count, int value) {
+    if (from >= count || list[from] >= value) return from;
+
+    int low = from, step = 1;
+    int high = from + 1;
+    while (high < count && list[high] < value) {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    if (high > count) high = count;
+
+    // list[low] < value e (high == count ou list[high] >= value)
+    while (low + 1 < high) {
+        int mid = low + (high - low) / 2;
+        if (list[mid] < value) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return high;
+}
+
+// =============================================================================
+// INTERSECÇÃO
+// =============================================================================
+
+int postings_intersect_merge(const int *a, int a_count, const int *b, int b_count, int *out) {
+    int n = 0, i = 0, j = 0;
+    while (i < a_count && j < b_count) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+int postings_intersect_galloping(const int *a, int a_count, const int *b, int b_count, int *out) {
+    if (a_count > b_count) {
+        const int *t = a;
+        a = b;
+        b = t;
+        int c = a_count;
+        a_count = b_count;
+        b_count = c;
+    }
+
+    int n = 0, j = 0;
+    for (int i = 0; i < a_count && j < b_count; i++) {
+        j = postings_gallop(b, j, b_count, a[i]);
+        if (j < b_count && b[j] == a[i]) out[n++] = a[i];
+    }
+    return n;
+}
+
+int postings_intersect_simd(const int *a, int a_count, const int *b, int b_count, int *out) {
+    int n = 0, i = 0, j = 0;
+#if defined(__AVX2__)
+    // Cada bloco de 8 valores de a é comparado com as 8 rotações do bloco de
+    // b; avança o bloco (ou os dois) com o menor último valor
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    while (i + 8 <= a_count && j + 8 <= b_count) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + j));
+
+        __m256i equal = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; r++) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(va, vb));
+        }
+
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        for (int k = 0; mask; k++, mask >>= 1) {
+            if (mask & 1) out[n++] = a[i + k];
+        }
+
+        int a_last = a[i + 7], b_last = b[j + 7];
+        if (a_last <= b_last) i += 8;
+        if (b_last <= a_last) j += 8;
+    }
+#endif
+    return n + postings_intersect_merge(a + i, a_count - i, b + j, b_count - j, out + n);
+}
+
+int postings_intersect_into(const int *a, int a_count, const int *b, int b_count, int *out) {
+    if (a_count <= 0 || b_count <= 0) return 0;
+
+    int small = a_count < b_count ? a_count : b_count;
+    int large = a_count < b_count ? b_count : a_count;
+    if (large / small >= POSTINGS_GALLOP_RATIO) {
+        return postings_intersect_galloping(a, a_count, b, b_count, out);
+    }
+    return postings_intersect_simd(a, a_count, b, b_count, out);
+}
+
+int* postings_intersect(const int *a, int a_count, const int *b, int b_count, int *result_count) {
+    *result_count = 0;
+    if (a_count <= 0 || b_count <= 0) return NULL;
+
+    int *results = malloc((a_count < b_count ? a_count : b_count) * sizeof(int));
+    if (!results) return NULL;
+
+    *result_count = postings_intersect_into(a, a_count, b, b_count, results);
+    if (*result_count == 0) {
+        free(results);
+        return NULL;
+    }
+    return results;
+}
+
+// =============================================================================
+// UNIÃO
+// =============================================================================
+
+int postings_union_merge(const int *a, int a_count, const int *b, int b_count, int *out) {
+    int n = 0, i = 0, j = 0;
+    while (i < a_count && j < b_count) {
+        if (a[i] < b[j]) {
+            out[n++] = a[i++];
+        } else if (a[i] > b[j]) {
+            out[n++] = b[j++];
+        } else {
+            out[n++] = a[i++];
+            j++;
+        }
+    }
+
+    memcpy(out + n, a + i, (a_count - i) * sizeof(int));
+    n += a_count - i;
+    memcpy(out + n, b + j, (b_count - j) * sizeof(int));
+    return n + b_count - j;
+}
+
+int postings_union_galloping(const int *a, int a_count, const int *b, int b_count, int *out) {
+    if (a_count > b_count) {
+        const int *t = a;
+        a = b;
+        b = t;
+        int c = a_count;
+        a_count = b_count;
+        b_count = c;
+    }
+
+    int n = 0, j = 0;
+    for (int i = 0; i < a_count; i++) {
+        int pos = postings_gallop(b, j, b_count, a[i]);
+        memcpy(out + n, b + j, (pos - j) * sizeof(int));
+        n += pos - j;
+        j = pos;
+
+        out[n++] = a[i];
+        if (j < b_count && b[j] == a[i]) j++;
+    }
+
+    memcpy(out + n, b + j, (b_count - j) * sizeof(int));
+    return n + b_count - j;
+}
+
+int postings_union_into(const int *a, int a_count, const int *b, int b_count, int *out) {
+    if (a_count < 0) a_count = 0;
+    if (b_count < 0) b_count = 0;
+
+    int small = a_count < b_count ? a_count : b_count;
+    int large = a_count < b_count ? b_count : a_count;
+    if (small > 0 && large / small >= POSTINGS_GALLOP_RATIO) {
+        return postings_union_galloping(a, a_count, b, b_count, out);
+    }
+    return postings_union_merge(a, a_count, b, b_count, out);
+}
+
+int* postings_union(const int *a, int a_count, const int *b, int b_count, int *result_count) {
+    *result_count = 0;
+    int total = (a_count > 0 ? a_count : 0) + (b_count > 0 ? b_count : 0);
+    if (total == 0) return NULL;
+
+    int *results = malloc(total * sizeof(int));
+    if (!results) return NULL;
+
+    *result_count = postings_union_into(a, a_count, b, b_count, results);
+    return results;
+}
+
+// =============================================================================
+// NORMALIZAÇÃO
+// =============================================================================
+
+static int postings_compare(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int postings_normalize(int *ids, int count) {
+    if (!ids || count <= 1) return count > 0 ? count : 0;
+
+    int i = 1;
+    while (i < count && ids[i - 1] < ids[i]) {
+        i++;
+    }
+    if (i == count) return count;
+
+    qsort(ids, count, sizeof(int), postings_compare);
+
+    int n = 1;
+    for (i = 1; i < count; i++) {
+        if (ids[i] != ids[n - 1]) ids[n++] = ids[i];
+    }
+    return n;
+}
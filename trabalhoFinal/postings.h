@@ -0,0 +1,37 @@
+// =============================================================================
+// postings.h - Intersecção e união de listas ordenadas de fact_ids
+// =============================================================================
+#ifndef POSTINGS_H
+#define POSTINGS_H
+
+// As listas de entrada devem estar em ordem estritamente crescente, como as
+// listas de valores das Tries. As funções *_into escrevem em out, que precisa
+// de espaço para min(a_count, b_count) valores na intersecção e a_count +
+// b_count na união, e retornam a quantidade escrita.
+
+// Escolhem o algoritmo pela razão entre os tamanhos das listas
+int postings_intersect_into(const int *a, int a_count, const int *b, int b_count, int *out);
+int postings_union_into(const int *a, int a_count, const int *b, int b_count, int *out);
+
+// Mesmas operações alocando o resultado (NULL se vazio)
+int* postings_intersect(const int *a, int a_count, const int *b, int b_count, int *result_count);
+int* postings_union(const int *a, int a_count, const int *b, int b_count, int *result_count);
+
+// Algoritmos de intersecção:
+//  - merge: percorre as duas listas, O(a + b)
+//  - galloping: busca exponencial de cada valor da menor na maior, O(a log b)
+//  - simd: compara blocos de 8 valores com AVX2 (sem AVX2 usa o merge)
+int postings_intersect_merge(const int *a, int a_count, const int *b, int b_count, int *out);
+int postings_intersect_galloping(const int *a, int a_count, const int *b, int b_count, int *out);
+int postings_intersect_simd(const int *a, int a_count, const int *b, int b_count, int *out);
+
+// Algoritmos de união: merge ou galloping (copia em bloco os trechos da
+// maior lista entre dois valores da menor)
+int postings_union_merge(const int *a, int a_count, const int *b, int b_count, int *out);
+int postings_union_galloping(const int *a, int a_count, const int *b, int b_count, int *out);
+
+// Ordena e remove repetições se a lista ainda não estiver em ordem estrita.
+// Retorna o novo tamanho.
+int postings_normalize(int *ids, int count);
+
+#endif
@@ -0,0 +1,986 @@
+#include "roaring_bitmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Tipos de contêiner
+#define ROARING_ARRAY 0
+#define ROARING_BITSET 1
+#define ROARING_RUN 2
+
+#define ROARING_ARRAY_MAX 4096      // Acima disso o bitset (8 KB) é menor que o vetor
+#define ROARING_BITSET_WORDS 1024   // 65536 bits
+#define ROARING_DIRTY (-1)          // Cardinalidade de bitset ainda não recontada
+
+// Sequência contínua start..start+length
+typedef struct {
+    uint16_t start;
+    uint16_t length;
+} RoaringRun;
+
+struct RoaringContainer {
+    int type;
+    int cardinality;
+    int count;                  // Elementos do vetor ou quantidade de runs
+    int capacity;               // Capacidade do vetor ou de runs
+    union {
+        uint16_t *array;
+        uint64_t *bits;
+        RoaringRun *runs;
+    } data;
+};
+
+// =============================================================================
+// OPERAÇÕES DE BITS
+// =============================================================================
+
+static inline int roaring_popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline int roaring_ctz64(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int roaring_bits_count(const uint64_t *bits) {
+    int count = 0;
+    for (int i = 0; i < ROARING_BITSET_WORDS; i++) {
+        count += roaring_popcount64(bits[i]);
+    }
+    return count;
+}
+
+// Máscara dos bits start..end (inclusive) dentro de uma palavra
+static inline uint64_t roaring_word_mask(int start, int end) {
+    return (~0ULL << start) & (~0ULL >> (63 - end));
+}
+
+static void roaring_bits_set_range(uint64_t *bits, int start, int end) {
+    int first = start >> 6, last = end >> 6;
+    if (first == last) {
+        bits[first] |= roaring_word_mask(start & 63, end & 63);
+        return;
+    }
+    bits[first] |= roaring_word_mask(start & 63, 63);
+    for (int i = first + 1; i < last; i++) {
+        bits[i] = ~0ULL;
+    }
+    bits[last] |= roaring_word_mask(0, end & 63);
+}
+
+static int roaring_bits_count_range(const uint64_t *bits, int start, int end) {
+    int first = start >> 6, last = end >> 6;
+    if (first == last) {
+        return roaring_popcount64(bits[first] & roaring_word_mask(start & 63, end & 63));
+    }
+    int count = roaring_popcount64(bits[first] & roaring_word_mask(start & 63, 63));
+    for (int i = first + 1; i < last; i++) {
+        count += roaring_popcount64(bits[i]);
+    }
+    return count + roaring_popcount64(bits[last] & roaring_word_mask(0, end & 63));
+}
+
+// out = a & b (out pode ser igual a a)
+static void roaring_bits_and(uint64_t *out, const uint64_t *a, const uint64_t *b) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= ROARING_BITSET_WORDS; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_and_si256(x, y));
+    }
+#endif
+    for (; i < ROARING_BITSET_WORDS; i++) {
+        out[i] = a[i] & b[i];
+    }
+}
+
+static void roaring_bits_or(uint64_t *out, const uint64_t *in) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= ROARING_BITSET_WORDS; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(out + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_or_si256(x, y));
+    }
+#endif
+    for (; i < ROARING_BITSET_WORDS; i++) {
+        out[i] |= in[i];
+    }
+}
+
+// =============================================================================
+// CONTÊINERES
+// =============================================================================
+
+static void roaring_container_free(RoaringContainer *c) {
+    free(c->data.array);
+    memset(c, 0, sizeof(RoaringContainer));
+}
+
+// Garante espaço para needed elementos no vetor ou nos runs
+static int roaring_reserve(RoaringContainer *c, int needed, size_t element_size) {
+    if (needed <= c->capacity) return 1;
+
+    int capacity = c->capacity > 0 ? c->capacity * 2 : 4;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    void *data = realloc(c->data.array, capacity * element_size);
+    if (!data) return 0;
+
+    c->data.array = data;
+    c->capacity = capacity;
+    return 1;
+}
+
+// Primeira posição do vetor com valor >= value
+static int roaring_array_position(const uint16_t *array, int count, uint16_t value) {
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (array[mid] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Run que contém value ou -1
+static int roaring_run_find(const RoaringRun *runs, int count, uint16_t value) {
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (runs[mid].start <= value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low > 0 && value <= runs[low - 1].start + runs[low - 1].length) {
+        return low - 1;
+    }
+    return -1;
+}
+
+static int roaring_run_count(const RoaringContainer *c) {
+    if (c->type == ROARING_RUN) return c->count;
+
+    int runs = 0;
+    if (c->type == ROARING_ARRAY) {
+        for (int i = 0; i < c->count; i++) {
+            if (i == 0 || c->data.array[i] != c->data.array[i - 1] + 1) runs++;
+        }
+    } else {
+        // Um run começa em cada bit ligado cujo bit anterior está desligado
+        uint64_t previous = 0;
+        for (int i = 0; i < ROARING_BITSET_WORDS; i++) {
+            uint64_t word = c->data.bits[i];
+            runs += roaring_popcount64(word & ~((word << 1) | (previous >> 63)));
+            previous = word;
+        }
+    }
+    return runs;
+}
+
+static int roaring_convert_to_bitset(RoaringContainer *c) {
+    if (c->type == ROARING_BITSET) return 1;
+
+    uint64_t *bits = calloc(ROARING_BITSET_WORDS, sizeof(uint64_t));
+    if (!bits) return 0;
+
+    if (c->type == ROARING_ARRAY) {
+        for (int i = 0; i < c->count; i++) {
+            bits[c->data.array[i] >> 6] |= 1ULL << (c->data.array[i] & 63);
+        }
+    } else {
+        for (int i = 0; i < c->count; i++) {
+            roaring_bits_set_range(bits, c->data.runs[i].start, c->data.runs[i].start + c->data.runs[i].length);
+        }
+    }
+
+    free(c->data.array);
+    c->data.bits = bits;
+    c->type = ROARING_BITSET;
+    c->count = 0;
+    c->capacity = 0;
+    return 1;
+}
+
+// Bitset ou runs com no máximo ROARING_ARRAY_MAX valores -> vetor
+static int roaring_convert_to_array(RoaringContainer *c) {
+    if (c->type == ROARING_ARRAY) return 1;
+
+    uint16_t *array = malloc((c->cardinality > 0 ? c->cardinality : 1) * sizeof(uint16_t));
+    if (!array) return 0;
+
+    int n = 0;
+    if (c->type == ROARING_BITSET) {
+        for (int i = 0; i < ROARING_BITSET_WORDS; i++) {
+            uint64_t word = c->data.bits[i];
+            while (word) {
+                array[n++] = (uint16_t)(i * 64 + roaring_ctz64(word));
+                word &= word - 1;
+            }
+        }
+    } else {
+        for (int i = 0; i < c->count; i++) {
+            for (int v = c->data.runs[i].start; v <= c->data.runs[i].start + c->data.runs[i].length; v++) {
+                array[n++] = (uint16_t)v;
+            }
+        }
+    }
+
+    free(c->data.array);
+    c->data.array = array;
+    c->type = ROARING_ARRAY;
+    c->count = n;
+    c->capacity = c->cardinality > 0 ? c->cardinality : 1;
+    return 1;
+}
+
+static int roaring_convert_to_runs(RoaringContainer *c, int run_count) {
+    if (c->type == ROARING_RUN) return 1;
+
+    RoaringRun *runs = malloc((run_count > 0 ? run_count : 1) * sizeof(RoaringRun));
+    if (!runs) return 0;
+
+    // Percorre os valores em ordem estendendo o run atual enquanto são contíguos
+    int n = 0;
+    int previous = -2;
+    if (c->type == ROARING_ARRAY) {
+        for (int i = 0; i < c->count; i++) {
+            int v = c->data.array[i];
+            if (v == previous + 1) {
+                runs[n - 1].length++;
+            } else {
+                runs[n].start = (uint16_t)v;
+                runs[n++].length = 0;
+            }
+            previous = v;
+        }
+    } else {
+        for (int i = 0; i < ROARING_BITSET_WORDS; i++) {
+            uint64_t word = c->data.bits[i];
+            while (word) {
+                int v = i * 64 + roaring_ctz64(word);
+                if (v == previous + 1) {
+                    runs[n - 1].length++;
+                } else {
+                    runs[n].start = (uint16_t)v;
+                    runs[n++].length = 0;
+                }
+                previous = v;
+                word &= word - 1;
+            }
+        }
+    }
+
+    free(c->data.array);
+    c->data.runs = runs;
+    c->type = ROARING_RUN;
+    c->count = n;
+    c->capacity = run_count > 0 ? run_count : 1;
+    return 1;
+}
+
+// Runs viram vetor ou bitset conforme a cardinalidade
+static int roaring_convert_from_runs(RoaringContainer *c) {
+    return c->cardinality <= ROARING_ARRAY_MAX ? roaring_convert_to_array(c) : roaring_convert_to_bitset(c);
+}
+
+// Escolhe a menor representação para o contêiner
+static int roaring_container_optimize(RoaringContainer *c) {
+    size_t run_size = roaring_run_count(c) * sizeof(RoaringRun);
+    size_t bitset_size = ROARING_BITSET_WORDS * sizeof(uint64_t);
+    size_t array_size = c->cardinality <= ROARING_ARRAY_MAX ? c->cardinality * sizeof(uint16_t) : bitset_size + 1;
+
+    if (run_size < array_size && run_size < bitset_size) {
+        if (c->type == ROARING_RUN) {
+            // Devolve a sobra do vetor de runs
+            RoaringRun *runs = realloc(c->data.runs, (c->count > 0 ? c->count : 1) * sizeof(RoaringRun));
+            if (runs) {
+                c->data.runs = runs;
+                c->capacity = c->count > 0 ? c->count : 1;
+            }
+            return 1;
+        }
+        return roaring_convert_to_runs(c, roaring_run_count(c));
+    }
+    if (array_size <= bitset_size) {
+        if (c->type == ROARING_ARRAY) {
+            uint16_t *array = realloc(c->data.array, (c->count > 0 ? c->count : 1) * sizeof(uint16_t));
+            if (array) {
+                c->data.array = array;
+                c->capacity = c->count > 0 ? c->count : 1;
+            }
+            return 1;
+        }
+        return roaring_convert_to_array(c);
+    }
+    return roaring_convert_to_bitset(c);
+}
+
+static int roaring_container_contains(const RoaringContainer *c, uint16_t value) {
+    switch (c->type) {
+        case ROARING_ARRAY: {
+            int pos = roaring_array_position(c->data.array, c->count, value);
+            return pos < c->count && c->data.array[pos] == value;
+        }
+        case ROARING_BITSET:
+            return (int)((c->data.bits[value >> 6] >> (value & 63)) & 1);
+        default:
+            return roaring_run_find(c->data.runs, c->count, value) >= 0;
+    }
+}
+
+static int roaring_container_add(RoaringContainer *c, uint16_t value) {
+    if (c->type == ROARING_RUN) {
+        // Fatos chegam em ordem crescente: estender o último run é o caso comum
+        if (c->count > 0) {
+            RoaringRun *last = &c->data.runs[c->count - 1];
+            if (value == last->start + last->length + 1) {
+                last->length++;
+                c->cardinality++;
+                return 1;
+            }
+        }
+        if (roaring_run_find(c->data.runs, c->count, value) >= 0) return 1;
+        if (!roaring_convert_from_runs(c)) return 0;
+    }
+
+    if (c->type == ROARING_ARRAY) {
+        int pos = (c->count > 0 && value > c->data.array[c->count - 1])
+                  ? c->count : roaring_array_position(c->data.array, c->count, value);
+        if (pos < c->count && c->data.array[pos] == value) return 1;
+
+        if (c->count < ROARING_ARRAY_MAX) {
+            if (!roaring_reserve(c, c->count + 1, sizeof(uint16_t))) return 0;
+            memmove(&c->data.array[pos + 1], &c->data.array[pos], (c->count - pos) * sizeof(uint16_t));
+            c->data.array[pos] = value;
+            c->count++;
+            c->cardinality++;
+            return 1;
+        }
+        if (!roaring_convert_to_bitset(c)) return 0;
+    }
+
+    uint64_t mask = 1ULL << (value & 63);
+    if (!(c->data.bits[value >> 6] & mask)) {
+        c->data.bits[value >> 6] |= mask;
+        c->cardinality++;
+    }
+    return 1;
+}
+
+static int roaring_container_copy(RoaringContainer *out, const RoaringContainer *c) {
+    size_t size;
+    int capacity = c->count > 0 ? c->count : 1;
+    switch (c->type) {
+        case ROARING_ARRAY: size = capacity * sizeof(uint16_t); break;
+        case ROARING_BITSET: size = ROARING_BITSET_WORDS * sizeof(uint64_t); break;
+        default: size = capacity * sizeof(RoaringRun); break;
+    }
+
+    void *data = malloc(size);
+    if (!data) return 0;
+    memcpy(data, c->data.array, c->type == ROARING_BITSET ? size : (size_t)c->count * (size / capacity));
+
+    *out = *c;
+    out->data.array = data;
+    out->capacity = c->type == ROARING_BITSET ? 0 : capacity;
+    return 1;
+}
+
+// =============================================================================
+// INTERSECÇÃO DE CONTÊINERES
+// =============================================================================
+//
+// Os pares são ordenados por tipo (vetor < bitset < runs), então cada função
+// trata uma combinação. O resultado vai para out, que chega zerado.
+
+static int roaring_new_array(RoaringContainer *out, int capacity) {
+    out->type = ROARING_ARRAY;
+    out->data.array = malloc((capacity > 0 ? capacity : 1) * sizeof(uint16_t));
+    out->capacity = capacity > 0 ? capacity : 1;
+    return out->data.array != NULL;
+}
+
+static int roaring_and_array_array(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    if (a->count > b->count) {
+        const RoaringContainer *t = a;
+        a = b;
+        b = t;
+    }
+    if (!roaring_new_array(out, a->count)) return 0;
+
+    const uint16_t *small = a->data.array, *large = b->data.array;
+    int n = 0;
+    if (a->count * 64 < b->count) {
+        // Tamanhos muito diferentes: busca binária de cada valor do menor
+        int from = 0;
+        for (int i = 0; i < a->count && from < b->count; i++) {
+            from += roaring_array_position(large + from, b->count - from, small[i]);
+            if (from < b->count && large[from] == small[i]) out->data.array[n++] = small[i];
+        }
+    } else {
+        int i = 0, j = 0;
+        while (i < a->count && j < b->count) {
+            if (small[i] < large[j]) {
+                i++;
+            } else if (small[i] > large[j]) {
+                j++;
+            } else {
+                out->data.array[n++] = small[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    out->count = out->cardinality = n;
+    return 1;
+}
+
+static int roaring_and_array_bitset(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    if (!roaring_new_array(out, a->count)) return 0;
+
+    int n = 0;
+    for (int i = 0; i < a->count; i++) {
+        uint16_t v = a->data.array[i];
+        if ((b->data.bits[v >> 6] >> (v & 63)) & 1) out->data.array[n++] = v;
+    }
+
+    out->count = out->cardinality = n;
+    return 1;
+}
+
+static int roaring_and_array_run(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    if (!roaring_new_array(out, a->count)) return 0;
+
+    int n = 0, i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        int v = a->data.array[i];
+        int start = b->data.runs[j].start, end = start + b->data.runs[j].length;
+        if (v < start) {
+            i++;
+        } else if (v > end) {
+            j++;
+        } else {
+            out->data.array[n++] = (uint16_t)v;
+            i++;
+        }
+    }
+
+    out->count = out->cardinality = n;
+    return 1;
+}
+
+// Resultado em bitset passa a vetor quando fica pequeno
+static int roaring_finish_bitset(RoaringContainer *out) {
+    out->cardinality = roaring_bits_count(out->data.bits);
+    return out->cardinality <= ROARING_ARRAY_MAX ? roaring_convert_to_array(out) : 1;
+}
+
+static int roaring_and_bitset_bitset(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    out->type = ROARING_BITSET;
+    out->data.bits = malloc(ROARING_BITSET_WORDS * sizeof(uint64_t));
+    if (!out->data.bits) return 0;
+
+    roaring_bits_and(out->data.bits, a->data.bits, b->data.bits);
+    return roaring_finish_bitset(out);
+}
+
+static int roaring_and_bitset_run(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    out->type = ROARING_BITSET;
+    out->data.bits = calloc(ROARING_BITSET_WORDS, sizeof(uint64_t));
+    if (!out->data.bits) return 0;
+
+    // Copia do bitset só as palavras cobertas pelos runs
+    for (int r = 0; r < b->count; r++) {
+        int start = b->data.runs[r].start, end = start + b->data.runs[r].length;
+        for (int w = start >> 6; w <= end >> 6; w++) {
+            int from = w == (start >> 6) ? (start & 63) : 0;
+            int to = w == (end >> 6) ? (end & 63) : 63;
+            out->data.bits[w] |= a->data.bits[w] & roaring_word_mask(from, to);
+        }
+    }
+    return roaring_finish_bitset(out);
+}
+
+static int roaring_and_run_run(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    out->type = ROARING_RUN;
+    out->capacity = a->count + b->count > 0 ? a->count + b->count : 1;
+    out->data.runs = malloc(out->capacity * sizeof(RoaringRun));
+    if (!out->data.runs) return 0;
+
+    int i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        int a_end = a->data.runs[i].start + a->data.runs[i].length;
+        int b_end = b->data.runs[j].start + b->data.runs[j].length;
+        int start = a->data.runs[i].start > b->data.runs[j].start ? a->data.runs[i].start : b->data.runs[j].start;
+        int end = a_end < b_end ? a_end : b_end;
+
+        if (start <= end) {
+            out->data.runs[out->count].start = (uint16_t)start;
+            out->data.runs[out->count++].length = (uint16_t)(end - start);
+            out->cardinality += end - start + 1;
+        }
+        if (a_end < b_end) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return 1;
+}
+
+static int roaring_container_and(const RoaringContainer *a, const RoaringContainer *b, RoaringContainer *out) {
+    if (a->type > b->type) {
+        const RoaringContainer *t = a;
+        a = b;
+        b = t;
+    }
+
+    if (a->type == ROARING_ARRAY) {
+        if (b->type == ROARING_ARRAY) return roaring_and_array_array(a, b, out);
+        if (b->type == ROARING_BITSET) return roaring_and_array_bitset(a, b, out);
+        return roaring_and_array_run(a, b, out);
+    }
+    if (a->type == ROARING_BITSET) {
+        if (b->type == ROARING_BITSET) return roaring_and_bitset_bitset(a, b, out);
+        return roaring_and_bitset_run(a, b, out);
+    }
+    return roaring_and_run_run(a, b, out);
+}
+
+// Mesmas combinações da intersecção, só contando
+static int roaring_container_and_count(const RoaringContainer *a, const RoaringContainer *b) {
+    if (a->type > b->type) {
+        const RoaringContainer *t = a;
+        a = b;
+        b = t;
+    }
+
+    int count = 0;
+    if (a->type == ROARING_ARRAY && b->type == ROARING_ARRAY) {
+        int i = 0, j = 0;
+        while (i < a->count && j < b->count) {
+            if (a->data.array[i] < b->data.array[j]) {
+                i++;
+            } else if (a->data.array[i] > b->data.array[j]) {
+                j++;
+            } else {
+                count++;
+                i++;
+                j++;
+            }
+        }
+    } else if (a->type == ROARING_ARRAY && b->type == ROARING_BITSET) {
+        for (int i = 0; i < a->count; i++) {
+            uint16_t v = a->data.array[i];
+            count += (int)((b->data.bits[v >> 6] >> (v & 63)) & 1);
+        }
+    } else if (a->type == ROARING_ARRAY) {
+        int i = 0, j = 0;
+        while (i < a->count && j < b->count) {
+            int v = a->data.array[i];
+            int start = b->data.runs[j].start, end = start + b->data.runs[j].length;
+            if (v < start) {
+                i++;
+            } else if (v > end) {
+                j++;
+            } else {
+                count++;
+                i++;
+            }
+        }
+    } else if (b->type == ROARING_BITSET) {
+        for (int i = 0; i < ROARING_BITSET_WORDS; i++) {
+            count += roaring_popcount64(a->data.bits[i] & b->data.bits[i]);
+        }
+    } else if (a->type == ROARING_BITSET) {
+        for (int r = 0; r < b->count; r++) {
+            count += roaring_bits_count_range(a->data.bits, b->data.runs[r].start,
+                                              b->data.runs[r].start + b->data.runs[r].length);
+        }
+    } else {
+        int i = 0, j = 0;
+        while (i < a->count && j < b->count) {
+            int a_end = a->data.runs[i].start + a->data.runs[i].length;
+            int b_end = b->data.runs[j].start + b->data.runs[j].length;
+            int start = a->data.runs[i].start > b->data.runs[j].start ? a->data.runs[i].start : b->data.runs[j].start;
+            int end = a_end < b_end ? a_end : b_end;
+            if (start <= end) count += end - start + 1;
+            if (a_end < b_end) {
+                i++;
+            } else {
+                j++;
+            }
+        }
+    }
+    return count;
+}
+
+// =============================================================================
+// UNIÃO DE CONTÊINERES
+// =============================================================================
+
+static int roaring_or_array_array(RoaringContainer *t, const RoaringContainer *s) {
+    uint16_t *merged = malloc((t->count + s->count) * sizeof(uint16_t));
+    if (!merged) return 0;
+
+    int n = 0, i = 0, j = 0;
+    while (i < t->count || j < s->count) {
+        if (j >= s->count || (i < t->count && t->data.array[i] < s->data.array[j])) {
+            merged[n++] = t->data.array[i++];
+        } else if (i >= t->count || s->data.array[j] < t->data.array[i]) {
+            merged[n++] = s->data.array[j++];
+        } else {
+            merged[n++] = t->data.array[i++];
+            j++;
+        }
+    }
+
+    free(t->data.array);
+    t->data.array = merged;
+    t->capacity = t->count + s->count;
+    t->count = t->cardinality = n;
+    return 1;
+}
+
+static int roaring_or_run_run(RoaringContainer *t, const RoaringContainer *s) {
+    RoaringRun *merged = malloc((t->count + s->count) * sizeof(RoaringRun));
+    if (!merged) return 0;
+
+    // Percorre os runs pela ordem de início juntando os que se tocam
+    int n = 0, i = 0, j = 0, cardinality = 0;
+    int current_start = -1, current_end = -2;
+    while (i < t->count || j < s->count) {
+        const RoaringRun *next;
+        if (j >= s->count || (i < t->count && t->data.runs[i].start <= s->data.runs[j].start)) {
+            next = &t->data.runs[i++];
+        } else {
+            next = &s->data.runs[j++];
+        }
+
+        int start = next->start, end = next->start + next->length;
+        if (start <= current_end + 1) {
+            if (end > current_end) current_end = end;
+        } else {
+            if (current_start >= 0) {
+                merged[n].start = (uint16_t)current_start;
+                merged[n++].length = (uint16_t)(current_end - current_start);
+                cardinality += current_end - current_start + 1;
+            }
+            current_start = start;
+            current_end = end;
+        }
+    }
+    if (current_start >= 0) {
+        merged[n].start = (uint16_t)current_start;
+        merged[n++].length = (uint16_t)(current_end - current_start);
+        cardinality += current_end - current_start + 1;
+    }
+
+    free(t->data.runs);
+    t->data.runs = merged;
+    t->capacity = t->count + s->count;
+    t->count = n;
+    t->cardinality = cardinality;
+    return 1;
+}
+
+// t |= s. Quando o resultado passa a bitset a cardinalidade fica ROARING_DIRTY
+// e é recontada uma única vez no fim da união (roaring_finish_union)
+static int roaring_container_or(RoaringContainer *t, const RoaringContainer *s) {
+    if (s->cardinality == 0) return 1;
+
+    if (t->type == ROARING_ARRAY && s->type == ROARING_ARRAY &&
+        t->cardinality + s->cardinality <= ROARING_ARRAY_MAX) {
+        return roaring_or_array_array(t, s);
+    }
+    if (t->type == ROARING_RUN && s->type == ROARING_RUN) {
+        return roaring_or_run_run(t, s);
+    }
+
+    if (!roaring_convert_to_bitset(t)) return 0;
+
+    if (s->type == ROARING_ARRAY) {
+        for (int i = 0; i < s->count; i++) {
+            t->data.bits[s->data.array[i] >> 6] |= 1ULL << (s->data.array[i] & 63);
+        }
+    } else if (s->type == ROARING_BITSET) {
+        roaring_bits_or(t->data.bits, s->data.bits);
+    } else {
+        for (int i = 0; i < s->count; i++) {
+            roaring_bits_set_range(t->data.bits, s->data.runs[i].start, s->data.runs[i].start + s->data.runs[i].length);
+        }
+    }
+    t->cardinality = ROARING_DIRTY;
+    return 1;
+}
+
+// =============================================================================
+// BITMAP
+// =============================================================================
+
+void roaring_init(RoaringBitmap *bitmap) {
+    if (bitmap) memset(bitmap, 0, sizeof(RoaringBitmap));
+}
+
+void roaring_clear(RoaringBitmap *bitmap) {
+    if (!bitmap) return;
+
+    for (int i = 0; i < bitmap->count; i++) {
+        roaring_container_free(&bitmap->containers[i]);
+    }
+    free(bitmap->keys);
+    free(bitmap->containers);
+    memset(bitmap, 0, sizeof(RoaringBitmap));
+}
+
+// Posição do contêiner da chave (ou onde deveria ser inserido) a partir de from
+static int roaring_key_position(const RoaringBitmap *bitmap, int from, uint16_t key) {
+    if (bitmap->count > 0 && bitmap->keys[bitmap->count - 1] < key) return bitmap->count;
+
+    int low = from, high = bitmap->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (bitmap->keys[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static int roaring_insert_container(RoaringBitmap *bitmap, int pos, uint16_t key, const RoaringContainer *c) {
+    if (bitmap->count == bitmap->capacity) {
+        int capacity = bitmap->capacity > 0 ? bitmap->capacity * 2 : 4;
+        uint16_t *keys = realloc(bitmap->keys, capacity * sizeof(uint16_t));
+        if (!keys) return 0;
+        bitmap->keys = keys;
+
+        RoaringContainer *containers = realloc(bitmap->containers, capacity * sizeof(RoaringContainer));
+        if (!containers) return 0;
+        bitmap->containers = containers;
+        bitmap->capacity = capacity;
+    }
+
+    memmove(&bitmap->keys[pos + 1], &bitmap->keys[pos], (bitmap->count - pos) * sizeof(uint16_t));
+    memmove(&bitmap->containers[pos + 1], &bitmap->containers[pos],
+            (bitmap->count - pos) * sizeof(RoaringContainer));
+    bitmap->keys[pos] = key;
+    bitmap->containers[pos] = *c;
+    bitmap->count++;
+    return 1;
+}
+
+int roaring_add(RoaringBitmap *bitmap, int value) {
+    if (!bitmap || value < 0) return 0;
+
+    uint16_t key = (uint16_t)((uint32_t)value >> 16);
+    int pos = roaring_key_position(bitmap, 0, key);
+    if (pos == bitmap->count || bitmap->keys[pos] != key) {
+        RoaringContainer empty;
+        memset(&empty, 0, sizeof(empty));
+        empty.type = ROARING_ARRAY;
+        if (!roaring_insert_container(bitmap, pos, key, &empty)) return 0;
+    }
+
+    return roaring_container_add(&bitmap->containers[pos], (uint16_t)(value & 0xffff));
+}
+
+int roaring_contains(const RoaringBitmap *bitmap, int value) {
+    if (!bitmap || value < 0) return 0;
+
+    uint16_t key = (uint16_t)((uint32_t)value >> 16);
+    int pos = roaring_key_position(bitmap, 0, key);
+    return pos < bitmap->count && bitmap->keys[pos] == key &&
+           roaring_container_contains(&bitmap->containers[pos], (uint16_t)(value & 0xffff));
+}
+
+int roaring_cardinality(const RoaringBitmap *bitmap) {
+    if (!bitmap) return 0;
+
+    int count = 0;
+    for (int i = 0; i < bitmap->count; i++) {
+        count += bitmap->containers[i].cardinality;
+    }
+    return count;
+}
+
+int roaring_and_cardinality(const RoaringBitmap *a, const RoaringBitmap *b) {
+    if (!a || !b) return 0;
+
+    int count = 0, j = 0;
+    for (int i = 0; i < a->count && j < b->count; i++) {
+        j = roaring_key_position(b, j, a->keys[i]);
+        if (j < b->count && b->keys[j] == a->keys[i]) {
+            count += roaring_container_and_count(&a->containers[i], &b->containers[j]);
+        }
+    }
+    return count;
+}
+
+int roaring_and_into(RoaringBitmap *target, const RoaringBitmap *source) {
+    if (!target || !source) return 0;
+
+    // Só os contêineres de target são visitados; os de source são achados
+    // por busca binária, então um conjunto pequeno não percorre o grande
+    int kept = 0, j = 0, success = 1;
+    for (int i = 0; i < target->count; i++) {
+        RoaringContainer *c = &target->containers[i];
+        uint16_t key = target->keys[i];
+
+        j = roaring_key_position(source, j, key);
+        RoaringContainer result;
+        memset(&result, 0, sizeof(result));
+
+        if (success && j < source->count && source->keys[j] == key &&
+            !roaring_container_and(c, &source->containers[j], &result)) {
+            roaring_container_free(&result);
+            success = 0;
+        }
+        roaring_container_free(c);
+
+        if (result.cardinality > 0) {
+            target->keys[kept] = key;
+            target->containers[kept++] = result;
+        } else {
+            roaring_container_free(&result);
+        }
+    }
+
+    target->count = kept;
+    return success;
+}
+
+// Reconta os bitsets alterados pela união e devolve os pequenos a vetor
+static int roaring_finish_union(RoaringBitmap *bitmap) {
+    int success = 1;
+    for (int i = 0; i < bitmap->count; i++) {
+        RoaringContainer *c = &bitmap->containers[i];
+        if (c->cardinality == ROARING_DIRTY && !roaring_finish_bitset(c)) {
+            success = 0;
+        }
+    }
+    return success;
+}
+
+int roaring_or_many(RoaringBitmap *target, const RoaringBitmap *const *sources, int count) {
+    if (!target || (!sources && count > 0)) return 0;
+
+    int success = 1;
+    for (int s = 0; s < count && success; s++) {
+        const RoaringBitmap *source = sources[s];
+        if (!source) continue;
+
+        int pos = 0;
+        for (int k = 0; k < source->count && success; k++) {
+            uint16_t key = source->keys[k];
+            pos = roaring_key_position(target, pos, key);
+
+            if (pos < target->count && target->keys[pos] == key) {
+                success = roaring_container_or(&target->containers[pos], &source->containers[k]);
+            } else {
+                RoaringContainer copy;
+                success = roaring_container_copy(&copy, &source->containers[k]);
+                if (success && !roaring_insert_container(target, pos, key, &copy)) {
+                    roaring_container_free(&copy);
+                    success = 0;
+                }
+            }
+        }
+    }
+
+    if (!roaring_finish_union(target)) success = 0;
+    return success;
+}
+
+int roaring_or_into(RoaringBitmap *target, const RoaringBitmap *source) {
+    return roaring_or_many(target, &source, 1);
+}
+
+int* roaring_to_array(const RoaringBitmap *bitmap, int *count) {
+    *count = 0;
+    int total = roaring_cardinality(bitmap);
+    if (total == 0) return NULL;
+
+    int *values = malloc(total * sizeof(int));
+    if (!values) return NULL;
+
+    for (int i = 0; i < bitmap->count; i++) {
+        const RoaringContainer *c = &bitmap->containers[i];
+        int base = (int)bitmap->keys[i] << 16;
+
+        if (c->type == ROARING_ARRAY) {
+            for (int k = 0; k < c->count; k++) {
+                values[(*count)++] = base | c->data.array[k];
+            }
+        } else if (c->type == ROARING_BITSET) {
+            for (int w = 0; w < ROARING_BITSET_WORDS; w++) {
+                uint64_t word = c->data.bits[w];
+                while (word) {
+                    values[(*count)++] = base | (w * 64 + roaring_ctz64(word));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (int r = 0; r < c->count; r++) {
+                for (int v = c->data.runs[r].start; v <= c->data.runs[r].start + c->data.runs[r].length; v++) {
+                    values[(*count)++] = base | v;
+                }
+            }
+        }
+    }
+
+    return values;
+}
+
+void roaring_optimize(RoaringBitmap *bitmap) {
+    if (!bitmap) return;
+
+    for (int i = 0; i < bitmap->count; i++) {
+        roaring_container_optimize(&bitmap->containers[i]);
+    }
+}
+
+size_t roaring_memory(const RoaringBitmap *bitmap) {
+    if (!bitmap) return 0;
+
+    size_t total = bitmap->capacity * (sizeof(uint16_t) + sizeof(RoaringContainer));
+    for (int i = 0; i < bitmap->count; i++) {
+        const RoaringContainer *c = &bitmap->containers[i];
+        switch (c->type) {
+            case ROARING_ARRAY: total += c->capacity * sizeof(uint16_t); break;
+            case ROARING_BITSET: total += ROARING_BITSET_WORDS * sizeof(uint64_t); break;
+            default: total += c->capacity * sizeof(RoaringRun); break;
+        }
+    }
+    return total;
+}
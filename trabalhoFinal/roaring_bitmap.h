@@ -0,0 +1,55 @@
+// =============================================================================
+// roaring_bitmap.h - Bitmaps comprimidos para conjuntos de fact_ids
+// =============================================================================
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Os valores são divididos pelos 16 bits altos em contêineres de até 65536
+// valores. Cada contêiner usa a representação mais compacta para o seu
+// conteúdo: vetor ordenado (até 4096 valores), bitset de 8 KB ou sequências
+// contínuas (runs). A memória acompanha a quantidade de valores e as operações
+// entre dois bitmaps só visitam os contêineres que existem nos dois.
+//
+// Um RoaringBitmap zerado (memset ou {0}) é um bitmap vazio válido.
+typedef struct RoaringContainer RoaringContainer;
+
+typedef struct {
+    uint16_t *keys;                 // 16 bits altos de cada contêiner, em ordem
+    RoaringContainer *containers;
+    int count;
+    int capacity;
+} RoaringBitmap;
+
+void roaring_init(RoaringBitmap *bitmap);
+void roaring_clear(RoaringBitmap *bitmap);
+
+// Adiciona um valor (>= 0). Retorna 0 em erro de memória
+int roaring_add(RoaringBitmap *bitmap, int value);
+int roaring_contains(const RoaringBitmap *bitmap, int value);
+
+int roaring_cardinality(const RoaringBitmap *bitmap);
+
+// Tamanho da intersecção sem materializá-la
+int roaring_and_cardinality(const RoaringBitmap *a, const RoaringBitmap *b);
+
+// target |= source / target &= source. Retornam 0 em erro de memória
+int roaring_or_into(RoaringBitmap *target, const RoaringBitmap *source);
+int roaring_and_into(RoaringBitmap *target, const RoaringBitmap *source);
+
+// target |= união de todos os sources, recontando cada contêiner uma vez só
+int roaring_or_many(RoaringBitmap *target, const RoaringBitmap *const *sources, int count);
+
+// Valores em ordem crescente (NULL se vazio)
+int* roaring_to_array(const RoaringBitmap *bitmap, int *count);
+
+// Converte cada contêiner para a representação mais compacta, inclusive runs.
+// Útil depois de uma carga em lote.
+void roaring_optimize(RoaringBitmap *bitmap);
+
+// Bytes alocados pelo bitmap
+size_t roaring_memory(const RoaringBitmap *bitmap);
+
+#endif
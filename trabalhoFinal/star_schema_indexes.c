@@ -9,9 +9,33 @@
 #include <limits.h>
 #include <ctype.h>
 
+#ifdef _WIN32
+#include <direct.h>
+#define index_make_directory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define index_make_directory(path) mkdir(path, 0755)
+#endif
+
+// Cubo de agregações (implementado junto das agregações)
+static AggregateCube* aggregate_cube_build(DataWarehouse *dw);
+static void aggregate_cube_destroy(AggregateCube *cube);
+static int aggregate_cube_add_fact(AggregateCube *cube, DataWarehouse *dw, int row);
+
+// Somas acumuladas por ano (implementadas depois do cubo)
+static YearPrefixSums* year_sums_build(DataWarehouse *dw);
+static void year_sums_destroy(YearPrefixSums *sums);
+static int year_sums_add_fact(YearPrefixSums *sums, DataWarehouse *dw, int row);
+
 // =============================================================================
 // IMPLEMENTAÇÃO DO CACHE SYSTEM
 // =============================================================================
+//
+// Tabela hash com listas duplamente ligadas por bucket e uma lista LRU com
+// todas as entradas (lru_head = usada mais recentemente). Consultas e
+// inserções movem a entrada para o início; quando a quantidade de entradas ou
+// os bytes passam do limite, as entradas do fim são descartadas, cada uma em
+// O(1).
 
 static unsigned int hash_string(const char *str) {
     unsigned int hash = 5381;
@@ -21,7 +45,12 @@ static unsigned int hash_string(const char *str) {
     return hash % CACHE_SIZE;
 }
 
-CacheSystem* cache_system_create(int max_age) {
+// Memória contada para uma entrada: a estrutura e a lista de resultados
+static size_t cache_entry_bytes(int result_count) {
+    return sizeof(CacheEntry) + (size_t)result_count * sizeof(int);
+}
+
+CacheSystem* cache_system_create(int max_entries, size_t max_memory) {
     CacheSystem *cache = malloc(sizeof(CacheSystem));
     if (!cache) return NULL;
 
@@ -30,9 +59,13 @@ CacheSystem* cache_system_create(int max_age) {
     cache->lru_tail = NULL;
     cache->hit_count = 0;
     cache->miss_count = 0;
+    cache->eviction_count = 0;
     cache->current_size = 0;
-    cache->max_size = CACHE_SIZE;
-    cache->max_age = max_age;
+    cache->max_size = max_entries > 0 ? max_entries : CACHE_SIZE;
+    cache->memory_used = 0;
+    cache->max_memory = max_memory;
+    cache->generation = 0;
+    cache->valid_generation = 0;
 
     return cache;
 }
@@ -40,53 +73,99 @@ CacheSystem* cache_system_create(int max_age) {
 void cache_system_destroy(CacheSystem *cache) {
     if (!cache) return;
 
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        CacheEntry *entry = cache->entries[i];
-        while (entry) {
-            CacheEntry *next = entry->next;
-            free(entry->results);
-            free(entry);
-            entry = next;
-        }
+    CacheEntry *entry = cache->lru_head;
+    while (entry) {
+        CacheEntry *next = entry->lru_next;
+        free(entry->results);
+        free(entry);
+        entry = next;
     }
     free(cache);
 }
 
+static void cache_lru_unlink(CacheSystem *cache, CacheEntry *entry) {
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        cache->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void cache_lru_push_front(CacheSystem *cache, CacheEntry *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head) {
+        cache->lru_head->lru_prev = entry;
+    } else {
+        cache->lru_tail = entry;
+    }
+    cache->lru_head = entry;
+}
+
+// Tira a entrada do bucket e da lista LRU e libera sua memória
+static void cache_remove_entry(CacheSystem *cache, CacheEntry *entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->entries[entry->bucket] = entry->next;
+    }
+    if (entry->next) entry->next->prev = entry->prev;
+    cache_lru_unlink(cache, entry);
+
+    cache->memory_used -= cache_entry_bytes(entry->result_count);
+    cache->current_size--;
+    free(entry->results);
+    free(entry);
+}
+
+// Entrada válida com a chave; as de gerações anteriores encontradas no
+// caminho são removidas, pois os dados mudaram desde que foram calculadas
+static CacheEntry* cache_find(CacheSystem *cache, unsigned int bucket, const char *query_key) {
+    CacheEntry *entry = cache->entries[bucket];
+    while (entry) {
+        CacheEntry *next = entry->next;
+        if (entry->generation < cache->valid_generation) {
+            cache_remove_entry(cache, entry);
+        } else if (strcmp(entry->query_key, query_key) == 0) {
+            return entry;
+        }
+        entry = next;
+    }
+    return NULL;
+}
+
 int* cache_search(CacheSystem *cache, const char *query_key, int *result_count) {
     if (!cache || !query_key || !result_count) return NULL;
 
-    unsigned int hash = hash_string(query_key);
-    CacheEntry *entry = cache->entries[hash];
+    CacheEntry *entry = cache_find(cache, hash_string(query_key), query_key);
+    if (!entry) {
+        cache->miss_count++;
+        *result_count = 0;
+        return NULL;
+    }
 
-    while (entry) {
-        if (strcmp(entry->query_key, query_key) == 0) {
-            // Verificar se não expirou
-            time_t now = time(NULL);
-            if (now - entry->timestamp <= cache->max_age) {
-                cache->hit_count++;
-                entry->access_count++;
-                *result_count = entry->result_count;
-
-                // Verificar se há resultados antes de copiar
-                if (entry->result_count > 0 && entry->results) {
-                    int *results = malloc(entry->result_count * sizeof(int));
-                    if (results) {
-                        memcpy(results, entry->results, entry->result_count * sizeof(int));
-                        return results;
-                    }
-                }
+    cache->hit_count++;
+    entry->access_count++;
+    cache_lru_unlink(cache, entry);
+    cache_lru_push_front(cache, entry);
 
-                *result_count = 0;
-                return NULL;
-            } else {
-                // Entrada expirada - marcar como expirada
-                entry->result_count = 0;
-            }
+    // Verificar se há resultados antes de copiar
+    if (entry->result_count > 0 && entry->results) {
+        int *results = malloc(entry->result_count * sizeof(int));
+        if (results) {
+            memcpy(results, entry->results, entry->result_count * sizeof(int));
+            *result_count = entry->result_count;
+            return results;
         }
-        entry = entry->next;
     }
 
-    cache->miss_count++;
     *result_count = 0;
     return NULL;
 }
@@ -94,53 +173,100 @@ int* cache_search(CacheSystem *cache, const char *query_key, int *result_count)
 int cache_insert(CacheSystem *cache, const char *query_key, int *results, int result_count) {
     if (!cache || !query_key || !results || result_count <= 0) return 0;
 
-    unsigned int hash = hash_string(query_key);
+    // Resultado maior que o orçamento inteiro nunca é guardado
+    size_t bytes = cache_entry_bytes(result_count);
+    if (bytes > cache->max_memory) return 0;
 
-    CacheEntry *entry = malloc(sizeof(CacheEntry));
-    if (!entry) return 0;
+    int *copy = malloc(result_count * sizeof(int));
+    if (!copy) return 0;
+    memcpy(copy, results, result_count * sizeof(int));
 
-    strncpy(entry->query_key, query_key, MAX_QUERY_KEY_SIZE - 1);
-    entry->query_key[MAX_QUERY_KEY_SIZE - 1] = '\0';
+    unsigned int bucket = hash_string(query_key);
+    CacheEntry *entry = cache_find(cache, bucket, query_key);
 
-    entry->results = malloc(result_count * sizeof(int));
-    if (!entry->results) {
-        free(entry);
-        return 0;
+    if (entry) {
+        // Chave já presente: substitui o resultado em vez de duplicar
+        cache->memory_used -= cache_entry_bytes(entry->result_count);
+        free(entry->results);
+        cache_lru_unlink(cache, entry);
+    } else {
+        entry = malloc(sizeof(CacheEntry));
+        if (!entry) {
+            free(copy);
+            return 0;
+        }
+
+        strncpy(entry->query_key, query_key, MAX_QUERY_KEY_SIZE - 1);
+        entry->query_key[MAX_QUERY_KEY_SIZE - 1] = '\0';
+        entry->access_count = 0;
+
+        entry->bucket = bucket;
+        entry->prev = NULL;
+        entry->next = cache->entries[bucket];
+        if (entry->next) entry->next->prev = entry;
+        cache->entries[bucket] = entry;
+        cache->current_size++;
     }
 
-    memcpy(entry->results, results, result_count * sizeof(int));
+    entry->results = copy;
     entry->result_count = result_count;
-    entry->timestamp = time(NULL);
-    entry->access_count = 1;
+    entry->generation = cache->generation;
+    entry->access_count++;
+    cache->memory_used += bytes;
+    cache_lru_push_front(cache, entry);
 
-    entry->next = cache->entries[hash];
-    cache->entries[hash] = entry;
-    cache->current_size++;
+    // Descarta as menos usadas até respeitar os limites
+    while (cache->lru_tail != entry &&
+           (cache->current_size > cache->max_size || cache->memory_used > cache->max_memory)) {
+        cache_remove_entry(cache, cache->lru_tail);
+        cache->eviction_count++;
+    }
 
     return 1;
 }
 
+void cache_set_generation(CacheSystem *cache, unsigned long long generation) {
+    if (!cache || generation == cache->generation) return;
+
+    cache->generation = generation;
+    cache->valid_generation = generation;
+}
+
+void cache_advance_generation(CacheSystem *cache, unsigned long long generation) {
+    if (!cache) return;
+    cache->generation = generation;
+}
+
 void cache_cleanup_expired(CacheSystem *cache) {
     if (!cache) return;
 
-    time_t now = time(NULL);
-
-    for (int i = 0; i < CACHE_SIZE; i++) {
-        CacheEntry **entry_ptr = &cache->entries[i];
-        while (*entry_ptr) {
-            CacheEntry *entry = *entry_ptr;
-            if (now - entry->timestamp > cache->max_age) {
-                *entry_ptr = entry->next;
-                free(entry->results);
-                free(entry);
-                cache->current_size--;
-            } else {
-                entry_ptr = &entry->next;
-            }
+    CacheEntry *entry = cache->lru_head;
+    while (entry) {
+        CacheEntry *next = entry->lru_next;
+        if (entry->generation < cache->valid_generation) {
+            cache_remove_entry(cache, entry);
         }
+        entry = next;
     }
 }
 
+int cache_invalidate_matching(CacheSystem *cache, bool (*depends)(const char *query_key, void *context),
+                              void *context) {
+    if (!cache || !depends) return 0;
+
+    int removed = 0;
+    CacheEntry *entry = cache->lru_head;
+    while (entry) {
+        CacheEntry *next = entry->lru_next;
+        if (depends(entry->query_key, context)) {
+            cache_remove_entry(cache, entry);
+            removed++;
+        }
+        entry = next;
+    }
+    return removed;
+}
+
 void cache_print_statistics(CacheSystem *cache) {
     if (!cache) return;
 
@@ -151,96 +277,104 @@ void cache_print_statistics(CacheSystem *cache) {
            cache->hit_count + cache->miss_count > 0 ?
            (double)cache->hit_count / (cache->hit_count + cache->miss_count) * 100 : 0);
     printf("Current size: %d/%d\n", cache->current_size, cache->max_size);
+    printf("Memory: %zu/%zu bytes\n", cache->memory_used, cache->max_memory);
+    printf("Evictions: %d\n", cache->eviction_count);
+    printf("Generation: %llu\n", cache->generation);
 }
 
 // =============================================================================
 // BITMAP OPERATIONS
 // =============================================================================
 
+// Os bitmaps começam vazios: cada um só aloca contêineres para os blocos de
+// 65536 fact_ids em que tem algum fato
 int index_init_bitmaps(IndexSystem *idx) {
     if (!idx) return 0;
 
-    // Inicializar bitmaps para anos (1970-2169, 200 anos)
-    for (int i = 0; i < 200; i++) {
-        idx->year_bitmap[i] = calloc(1000, sizeof(unsigned char)); // 8000 bits
-        if (!idx->year_bitmap[i]) return 0;
-    }
-
-    // Inicializar bitmaps para países
-    for (int i = 0; i < 250; i++) {
-        idx->country_bitmap[i] = calloc(1000, sizeof(unsigned char));
-        if (!idx->country_bitmap[i]) return 0;
-    }
-
-    // Inicializar bitmaps para tipos de desastre
-    for (int i = 0; i < 100; i++) {
-        idx->disaster_bitmap[i] = calloc(1000, sizeof(unsigned char));
-        if (!idx->disaster_bitmap[i]) return 0;
-    }
+    memset(idx->year_bitmap, 0, sizeof(idx->year_bitmap));
+    idx->country_bitmap = NULL;
+    idx->country_bitmap_count = 0;
+    idx->disaster_bitmap = NULL;
+    idx->disaster_bitmap_count = 0;
+    idx->bitmaps_enabled = true;
 
     return 1;
 }
 
-void bitmap_set_bit(unsigned char *bitmap, int position) {
-    if (!bitmap) return;
-    int byte_index = position / 8;
-    int bit_index = position % 8;
-    bitmap[byte_index] |= (1 << bit_index);
-}
-
-void bitmap_clear_bit(unsigned char *bitmap, int position) {
-    if (!bitmap) return;
-    int byte_index = position / 8;
-    int bit_index = position % 8;
-    bitmap[byte_index] &= ~(1 << bit_index);
-}
-
-int bitmap_get_bit(unsigned char *bitmap, int position) {
-    if (!bitmap) return 0;
-    int byte_index = position / 8;
-    int bit_index = position % 8;
-    return (bitmap[byte_index] >> bit_index) & 1;
-}
+// Bitmap da chave em um vetor indexado pela chave, ampliado sob demanda
+static RoaringBitmap* index_key_bitmap(RoaringBitmap **bitmaps, int *count, int key) {
+    if (key < 0) return NULL;
 
-unsigned char* bitmap_and(unsigned char *bitmap1, unsigned char *bitmap2, int size) {
-    if (!bitmap1 || !bitmap2) return NULL;
+    if (key >= *count) {
+        int new_count = *count > 0 ? *count : 16;
+        while (new_count <= key) {
+            new_count *= 2;
+        }
 
-    unsigned char *result = malloc(size);
-    if (!result) return NULL;
+        RoaringBitmap *new_bitmaps = realloc(*bitmaps, new_count * sizeof(RoaringBitmap));
+        if (!new_bitmaps) return NULL;
 
-    for (int i = 0; i < size; i++) {
-        result[i] = bitmap1[i] & bitmap2[i];
+        memset(new_bitmaps + *count, 0, (new_count - *count) * sizeof(RoaringBitmap));
+        *bitmaps = new_bitmaps;
+        *count = new_count;
     }
 
-    return result;
+    return &(*bitmaps)[key];
 }
 
-unsigned char* bitmap_or(unsigned char *bitmap1, unsigned char *bitmap2, int size) {
-    if (!bitmap1 || !bitmap2) return NULL;
+// Marca o fato nos bitmaps de ano, geografia e tipo de desastre
+static int index_bitmaps_add_fact(IndexSystem *idx, int fact_id) {
+    if (!idx->bitmaps_enabled) return 1;
 
-    unsigned char *result = malloc(size);
-    if (!result) return NULL;
+    DisasterFact *fact = &idx->dw->fact_table[fact_id];
+    DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+    int success = 1;
 
-    for (int i = 0; i < size; i++) {
-        result[i] = bitmap1[i] | bitmap2[i];
+    if (time_dim && time_dim->start_year >= 1970 && time_dim->start_year < 2170) {
+        success &= roaring_add(&idx->year_bitmap[time_dim->start_year - 1970], fact_id);
+    }
+    if (dw_get_geography(idx->dw, fact->geography_key)) {
+        success &= roaring_add(index_key_bitmap(&idx->country_bitmap, &idx->country_bitmap_count,
+                                                fact->geography_key), fact_id);
+    }
+    if (dw_get_disaster_type(idx->dw, fact->disaster_type_key)) {
+        success &= roaring_add(index_key_bitmap(&idx->disaster_bitmap, &idx->disaster_bitmap_count,
+                                                fact->disaster_type_key), fact_id);
     }
 
-    return result;
+    return success;
 }
 
-int bitmap_count_bits(unsigned char *bitmap, int size) {
-    if (!bitmap) return 0;
-
-    int count = 0;
-    for (int i = 0; i < size; i++) {
-        unsigned char byte = bitmap[i];
-        while (byte) {
-            count += byte & 1;
-            byte >>= 1;
-        }
+static void index_free_bitmaps(IndexSystem *idx) {
+    for (int i = 0; i < 200; i++) {
+        roaring_clear(&idx->year_bitmap[i]);
+    }
+    for (int i = 0; i < idx->country_bitmap_count; i++) {
+        roaring_clear(&idx->country_bitmap[i]);
+    }
+    for (int i = 0; i < idx->disaster_bitmap_count; i++) {
+        roaring_clear(&idx->disaster_bitmap[i]);
     }
+    free(idx->country_bitmap);
+    free(idx->disaster_bitmap);
+    idx->country_bitmap = NULL;
+    idx->country_bitmap_count = 0;
+    idx->disaster_bitmap = NULL;
+    idx->disaster_bitmap_count = 0;
+}
 
-    return count;
+// Depois de uma carga completa cada contêiner passa à representação mais
+// compacta (anos e tipos frequentes costumam virar runs ou bitsets)
+static void index_optimize_bitmaps(IndexSystem *idx) {
+    for (int i = 0; i < 200; i++) {
+        roaring_optimize(&idx->year_bitmap[i]);
+    }
+    for (int i = 0; i < idx->country_bitmap_count; i++) {
+        roaring_optimize(&idx->country_bitmap[i]);
+    }
+    for (int i = 0; i < idx->disaster_bitmap_count; i++) {
+        roaring_optimize(&idx->disaster_bitmap[i]);
+    }
 }
 
 // =============================================================================
@@ -256,8 +390,11 @@ IndexConfiguration* index_config_create_default() {
     config->enable_bitmap_indexes = true;
     config->enable_composite_indexes = true;
     config->auto_rebuild = true;
+    config->map_bplus_indexes = false;
+    config->bplus_order = BPLUS_DEFAULT_ORDER;
+    config->bplus_fill_factor = 0.9;
     config->cache_size = 1000;
-    config->max_cache_age = 3600; // 1 hora
+    config->cache_memory = 8 * 1024 * 1024;
     strcpy(config->index_directory, "./indexes/");
 
     return config;
@@ -268,8 +405,10 @@ IndexConfiguration* index_config_create_high_performance() {
     if (!config) return NULL;
 
     config->cache_size = 5000;
-    config->max_cache_age = 7200; // 2 horas
+    config->cache_memory = 64 * 1024 * 1024;
     config->enable_bitmap_indexes = true;
+    config->map_bplus_indexes = true;
+    config->bplus_order = 128;
 
     return config;
 }
@@ -279,8 +418,10 @@ IndexConfiguration* index_config_create_low_memory() {
     if (!config) return NULL;
 
     config->enable_bitmap_indexes = false;
+    config->map_bplus_indexes = true;
+    config->bplus_fill_factor = 1.0;
     config->cache_size = 100;
-    config->max_cache_age = 900; // 15 minutos
+    config->cache_memory = 1024 * 1024;
 
     return config;
 }
@@ -293,6 +434,82 @@ void index_config_destroy(IndexConfiguration *config) {
 // SISTEMA DE ÍNDICES PRINCIPAL
 // =============================================================================
 
+// Arquivos dos índices persistidos, na ordem de index_trie_slots/index_bplus_slots
+#define INDEX_TRIE_COUNT 7
+#define INDEX_BPLUS_COUNT 6
+
+static const char *index_trie_files[INDEX_TRIE_COUNT] = {
+    "country_index.dat",
+    "disaster_type_index.dat",
+    "region_index.dat",
+    "subregion_index.dat",
+    "year_country_index.dat",
+    "disaster_country_index.dat",
+    "year_disaster_index.dat"
+};
+
+static const char *index_bplus_files[INDEX_BPLUS_COUNT] = {
+    "year_index.dat",
+    "deaths_index.dat",
+    "affected_index.dat",
+    "damage_index.dat",
+    "month_index.dat",
+    "day_index.dat"
+};
+
+// Coleta os ponteiros dos índices na mesma ordem das tabelas de arquivos
+static void index_trie_slots(IndexSystem *idx, Trie **slots[INDEX_TRIE_COUNT]) {
+    slots[0] = &idx->country_trie;
+    slots[1] = &idx->disaster_type_trie;
+    slots[2] = &idx->region_trie;
+    slots[3] = &idx->subregion_trie;
+    slots[4] = &idx->year_country_trie;
+    slots[5] = &idx->disaster_country_trie;
+    slots[6] = &idx->year_disaster_trie;
+}
+
+static void index_bplus_slots(IndexSystem *idx, BPlusTree **slots[INDEX_BPLUS_COUNT]) {
+    slots[0] = &idx->year_bplus;
+    slots[1] = &idx->deaths_bplus;
+    slots[2] = &idx->affected_bplus;
+    slots[3] = &idx->damage_bplus;
+    slots[4] = &idx->month_bplus;
+    slots[5] = &idx->day_bplus;
+}
+
+// Gerações crescentes e únicas no processo: um sistema novo nunca repete a
+// geração de outro, então entradas de cache antigas não passam por atuais
+static unsigned long long index_generation_counter = 0;
+
+static unsigned long long index_next_generation(void) {
+    return ++index_generation_counter;
+}
+
+// Caminho de um arquivo de índice dentro de index_base_path
+#define INDEX_PATH_SIZE 512
+
+static void index_file_path(IndexSystem *idx, const char *name, char *path, size_t size) {
+    size_t length = strlen(idx->index_base_path);
+    bool needs_separator = length > 0 && idx->index_base_path[length - 1] != '/' &&
+                           idx->index_base_path[length - 1] != '\\';
+    snprintf(path, size, "%s%s%s", idx->index_base_path, needs_separator ? "/" : "", name);
+}
+
+// Cria index_base_path (e os diretórios intermediários) se ainda não existir
+static void index_ensure_directory(IndexSystem *idx) {
+    char path[sizeof(idx->index_base_path)];
+    strcpy(path, idx->index_base_path);
+
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/' && *p != '\\') continue;
+        char separator = *p;
+        *p = '\0';
+        index_make_directory(path);
+        *p = separator;
+    }
+    if (path[0]) index_make_directory(path);
+}
+
 IndexSystem* index_system_create(DataWarehouse *dw) {
     IndexConfiguration *config = index_config_create_default();
     IndexSystem *idx = index_system_create_with_config(dw, config);
@@ -309,25 +526,27 @@ IndexSystem* index_system_create_with_config(DataWarehouse *dw, IndexConfigurati
     memset(idx, 0, sizeof(IndexSystem));
     idx->dw = dw;
 
+    strcpy(idx->index_base_path, config->index_directory);
+    char path[INDEX_PATH_SIZE];
+
     // Criar Tries reais ao invés de calloc
     if (config->enable_trie_indexes) {
-        idx->country_trie = trie_create("country_index.dat");
-        idx->disaster_type_trie = trie_create("disaster_type_index.dat");
-        idx->region_trie = trie_create("region_index.dat");
-        idx->subregion_trie = trie_create("subregion_index.dat");
-        idx->year_country_trie = trie_create("year_country_index.dat");
-        idx->disaster_country_trie = trie_create("disaster_country_index.dat");
-        idx->year_disaster_trie = trie_create("year_disaster_index.dat");
+        Trie **trie_slots[INDEX_TRIE_COUNT];
+        index_trie_slots(idx, trie_slots);
+        for (int i = 0; i < INDEX_TRIE_COUNT; i++) {
+            index_file_path(idx, index_trie_files[i], path, sizeof(path));
+            *trie_slots[i] = trie_create(path);
+        }
     }
 
     // Criar B+ Trees reais ao invés de calloc
     if (config->enable_bplus_indexes) {
-        idx->year_bplus = bplus_create("year_index.dat");
-        idx->deaths_bplus = bplus_create("deaths_index.dat");
-        idx->affected_bplus = bplus_create("affected_index.dat");
-        idx->damage_bplus = bplus_create("damage_index.dat");
-        idx->month_bplus = bplus_create("month_index.dat");
-        idx->day_bplus = bplus_create("day_index.dat");
+        BPlusTree **bplus_slots[INDEX_BPLUS_COUNT];
+        index_bplus_slots(idx, bplus_slots);
+        for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+            index_file_path(idx, index_bplus_files[i], path, sizeof(path));
+            *bplus_slots[i] = bplus_create_with_order(path, config->bplus_order);
+        }
     }
 
     // Inicializar bitmaps
@@ -335,9 +554,11 @@ IndexSystem* index_system_create_with_config(DataWarehouse *dw, IndexConfigurati
         index_init_bitmaps(idx);
     }
 
-    strcpy(idx->index_base_path, config->index_directory);
     idx->indexes_loaded = false;
+    idx->bplus_mapped = config->map_bplus_indexes;
+    idx->bplus_fill_factor = config->bplus_fill_factor;
     idx->last_rebuild_time = time(NULL);
+    idx->generation = index_next_generation();
 
     return idx;
 }
@@ -362,77 +583,92 @@ void index_system_destroy(IndexSystem *idx) {
     if (idx->month_bplus) bplus_destroy(idx->month_bplus);
     if (idx->day_bplus) bplus_destroy(idx->day_bplus);
 
-    // Liberar bitmaps
-    for (int i = 0; i < 200; i++) {
-        free(idx->year_bitmap[i]);
-    }
-    for (int i = 0; i < 250; i++) {
-        free(idx->country_bitmap[i]);
-    }
-    for (int i = 0; i < 100; i++) {
-        free(idx->disaster_bitmap[i]);
-    }
+    // Liberar bitmaps e agregações materializadas
+    index_free_bitmaps(idx);
+    aggregate_cube_destroy(idx->cube);
+    year_sums_destroy(idx->year_sums);
 
     free(idx);
 }
 
-int index_system_build_all(IndexSystem *idx) {
-    if (!idx || !idx->dw) return 0;
-
-    printf("Building indexes for %d facts...\n", idx->dw->fact_count);
-
-    // Construir índices para cada fato
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        if (!index_system_insert_entry(idx, i)) {
-            printf("Warning: Failed to index fact %d\n", i);
-        }
+// Chave do fato em cada B+ Tree, na ordem de index_bplus_slots. Retorna false
+// se a dimensão necessária não existir (o fato fica fora daquele índice).
+static bool index_bplus_fact_key(DataWarehouse *dw, int slot, const DisasterFact *fact, BPlusKey *key) {
+    DimTime *time_dim = NULL;
+    if (slot == 0 || slot == 4 || slot == 5) {
+        time_dim = dw_get_time(dw, fact->time_key);
+        if (!time_dim) return false;
     }
 
-    idx->indexes_loaded = true;
-    idx->last_rebuild_time = time(NULL);
-
-    printf("Indexes built successfully!\n");
-    return 1;
+    switch (slot) {
+        case 0: *key = time_dim->start_year; return true;
+        case 1: *key = fact->total_deaths; return true;
+        case 2: *key = fact->total_affected; return true;
+        case 3: *key = fact->total_damage; return true;
+        case 4: *key = time_dim->start_month; return true;
+        case 5: *key = time_dim->start_day; return true;
+        default: return false;
+    }
 }
 
-int index_system_rebuild(IndexSystem *idx) {
-    return index_system_build_all(idx);
+static int compare_bplus_entries(const void *a, const void *b) {
+    const BPlusEntry *entry_a = (const BPlusEntry *)a;
+    const BPlusEntry *entry_b = (const BPlusEntry *)b;
+    if (entry_a->key != entry_b->key) return entry_a->key < entry_b->key ? -1 : 1;
+    if (entry_a->value != entry_b->value) return entry_a->value < entry_b->value ? -1 : 1;
+    return 0;
 }
 
-int index_system_insert_entry(IndexSystem *idx, int fact_id) {
-    if (!idx || !idx->dw || fact_id >= idx->dw->fact_count || fact_id < 0) return 0;
+// Reconstrói cada B+ Tree ordenando sua coluna uma vez e carregando em lote.
+// A árvore nova só substitui a atual se a carga der certo.
+static void index_bulk_load_bplus(IndexSystem *idx) {
+    BPlusTree **slots[INDEX_BPLUS_COUNT];
+    index_bplus_slots(idx, slots);
 
-    DisasterFact *fact = &idx->dw->fact_table[fact_id];
+    BPlusEntry *entries = malloc((idx->dw->fact_count > 0 ? idx->dw->fact_count : 1) * sizeof(BPlusEntry));
+    if (!entries) {
+        printf("Warning: Failed to allocate B+ Tree build buffer\n");
+        return;
+    }
 
-    // Encontrar dimensões relacionadas
-    DimTime *time_dim = NULL;
-    DimGeography *geo_dim = NULL;
-    DimDisasterType *type_dim = NULL;
+    for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+        if (!*slots[i]) continue;
 
-    // Buscar dimensão tempo
-    for (int i = 0; i < idx->dw->time_count; i++) {
-        if (idx->dw->dim_time[i].time_key == fact->time_key) {
-            time_dim = &idx->dw->dim_time[i];
-            break;
+        int count = 0;
+        for (int fact_id = 0; fact_id < idx->dw->fact_count; fact_id++) {
+            if (index_bplus_fact_key(idx->dw, i, &idx->dw->fact_table[fact_id], &entries[count].key)) {
+                entries[count++].value = fact_id;
+            }
         }
-    }
-
-    // Buscar dimensão geografia
-    for (int i = 0; i < idx->dw->geography_count; i++) {
-        if (idx->dw->dim_geography[i].geography_key == fact->geography_key) {
-            geo_dim = &idx->dw->dim_geography[i];
-            break;
+        qsort(entries, count, sizeof(BPlusEntry), compare_bplus_entries);
+
+        char path[INDEX_PATH_SIZE];
+        index_file_path(idx, index_bplus_files[i], path, sizeof(path));
+        BPlusTree *tree = bplus_create_with_order(path, bplus_get_order(*slots[i]));
+        if (!tree || !bplus_bulk_load(tree, entries, count, idx->bplus_fill_factor)) {
+            printf("Warning: Failed to build %s\n", path);
+            bplus_destroy(tree);
+            continue;
         }
-    }
 
-    // Buscar dimensão tipo de desastre
-    for (int i = 0; i < idx->dw->disaster_type_count; i++) {
-        if (idx->dw->dim_disaster_type[i].disaster_type_key == fact->disaster_type_key) {
-            type_dim = &idx->dw->dim_disaster_type[i];
-            break;
-        }
+        bplus_destroy(*slots[i]);
+        *slots[i] = tree;
     }
 
+    free(entries);
+}
+
+// Insere o fato nas Tries e nos bitmaps e, se include_bplus, nas B+ Trees
+static int index_insert_fact(IndexSystem *idx, int fact_id, bool include_bplus) {
+    if (!idx || !idx->dw || fact_id >= idx->dw->fact_count || fact_id < 0) return 0;
+
+    DisasterFact *fact = &idx->dw->fact_table[fact_id];
+
+    // Encontrar dimensões relacionadas (acesso direto pela chave)
+    DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+    DimGeography *geo_dim = dw_get_geography(idx->dw, fact->geography_key);
+    DimDisasterType *type_dim = dw_get_disaster_type(idx->dw, fact->disaster_type_key);
+
     // Inserir nos índices Trie reais
     if (geo_dim && idx->country_trie) {
         trie_insert(idx->country_trie, geo_dim->country, fact_id);
@@ -449,27 +685,18 @@ int index_system_insert_entry(IndexSystem *idx, int fact_id) {
     }
 
     // Inserir nos índices B+ Tree reais
-    if (time_dim && idx->year_bplus) {
-        bplus_insert(idx->year_bplus, time_dim->start_year, fact_id);
-        if (idx->month_bplus) {
-            bplus_insert(idx->month_bplus, time_dim->start_month, fact_id);
-        }
-        if (idx->day_bplus) {
-            bplus_insert(idx->day_bplus, time_dim->start_day, fact_id);
+    if (include_bplus) {
+        BPlusTree **slots[INDEX_BPLUS_COUNT];
+        index_bplus_slots(idx, slots);
+
+        for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+            BPlusKey key;
+            if (*slots[i] && index_bplus_fact_key(idx->dw, i, fact, &key)) {
+                bplus_insert(*slots[i], key, fact_id);
+            }
         }
     }
 
-    if (idx->deaths_bplus) {
-        bplus_insert(idx->deaths_bplus, fact->total_deaths, fact_id);
-    }
-    if (idx->affected_bplus) {
-        // Para valores muito grandes, usar hash ou dividir por 1000
-        bplus_insert(idx->affected_bplus, (int)(fact->total_affected / 1000), fact_id);
-    }
-    if (idx->damage_bplus) {
-        bplus_insert(idx->damage_bplus, (int)(fact->total_damage / 1000), fact_id);
-    }
-
     // Inserir nos índices compostos
     if (geo_dim && time_dim && idx->year_country_trie) {
         char composite_key[100];
@@ -493,151 +720,397 @@ int index_system_insert_entry(IndexSystem *idx, int fact_id) {
     }
 
     // Atualizar bitmaps
-    if (time_dim && time_dim->start_year >= 1970 && time_dim->start_year < 2170) {
-        int year_index = time_dim->start_year - 1970;
-        if (year_index >= 0 && year_index < 200 && idx->year_bitmap[year_index]) {
-            bitmap_set_bit(idx->year_bitmap[year_index], fact_id);
+    return index_bitmaps_add_fact(idx, fact_id);
+}
+
+int index_system_build_all(IndexSystem *idx) {
+    if (!idx || !idx->dw) return 0;
+
+    printf("Building indexes for %d facts...\n", idx->dw->fact_count);
+
+    // Cubo e somas por ano são refeitos do zero no fim
+    aggregate_cube_destroy(idx->cube);
+    idx->cube = NULL;
+    year_sums_destroy(idx->year_sums);
+    idx->year_sums = NULL;
+
+    // Tries e bitmaps fato a fato; B+ Trees por ordenação e carga em lote
+    for (int i = 0; i < idx->dw->fact_count; i++) {
+        if (!index_insert_fact(idx, i, false)) {
+            printf("Warning: Failed to index fact %d\n", i);
         }
     }
+    index_bulk_load_bplus(idx);
+    if (idx->bitmaps_enabled) index_optimize_bitmaps(idx);
+    idx->cube = aggregate_cube_build(idx->dw);
+    idx->year_sums = year_sums_build(idx->dw);
+
+    idx->indexes_loaded = true;
+    idx->last_rebuild_time = time(NULL);
+    idx->generation = index_next_generation();
 
+    printf("Indexes built successfully!\n");
     return 1;
 }
 
-int index_system_save_all(IndexSystem *idx) {
-    if (!idx) return 0;
-
-    printf("Saving indexes to %s\n", idx->index_base_path);
+int index_system_rebuild(IndexSystem *idx) {
+    return index_system_build_all(idx);
+}
 
-    // Salvar Tries
-    if (idx->country_trie) trie_save_to_file(idx->country_trie);
-    if (idx->disaster_type_trie) trie_save_to_file(idx->disaster_type_trie);
-    if (idx->region_trie) trie_save_to_file(idx->region_trie);
-    if (idx->subregion_trie) trie_save_to_file(idx->subregion_trie);
-    if (idx->year_country_trie) trie_save_to_file(idx->year_country_trie);
-    if (idx->disaster_country_trie) trie_save_to_file(idx->disaster_country_trie);
-    if (idx->year_disaster_trie) trie_save_to_file(idx->year_disaster_trie);
+// B+ Trees mapeadas do disco são somente leitura: antes da primeira inserção
+// incremental cada uma é lida do mesmo arquivo para a memória. Retorna 0 se
+// algum arquivo não puder ser lido.
+static int index_bplus_make_writable(IndexSystem *idx) {
+    BPlusTree **slots[INDEX_BPLUS_COUNT];
+    index_bplus_slots(idx, slots);
 
-    // Salvar B+ Trees
-    if (idx->year_bplus) bplus_save_to_file(idx->year_bplus);
-    if (idx->deaths_bplus) bplus_save_to_file(idx->deaths_bplus);
-    if (idx->affected_bplus) bplus_save_to_file(idx->affected_bplus);
-    if (idx->damage_bplus) bplus_save_to_file(idx->damage_bplus);
-    if (idx->month_bplus) bplus_save_to_file(idx->month_bplus);
-    if (idx->day_bplus) bplus_save_to_file(idx->day_bplus);
+    for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+        if (!*slots[i] || !bplus_is_mapped(*slots[i])) continue;
 
+        char path[INDEX_PATH_SIZE];
+        index_file_path(idx, index_bplus_files[i], path, sizeof(path));
+        BPlusTree *tree = bplus_load_from_file(path);
+        if (!tree) return 0;
+        bplus_destroy(*slots[i]);
+        *slots[i] = tree;
+    }
     return 1;
 }
 
-int index_system_load_all(IndexSystem *idx) {
-    if (!idx) return 0;
+int index_system_insert_entry(IndexSystem *idx, int fact_id) {
+    if (!idx || !idx->dw) return 0;
 
-    printf("Loading indexes from %s\n", idx->index_base_path);
-    // Para esta implementação, apenas reconstrói os índices
-    return index_system_build_all(idx);
+    // Sem o arquivo as B+ Trees são refeitas em lote, já com o fato novo
+    bool include_bplus = true;
+    if (!index_bplus_make_writable(idx)) {
+        index_bulk_load_bplus(idx);
+        include_bplus = false;
+    }
+
+    idx->generation = index_next_generation();
+    if (!index_insert_fact(idx, fact_id, include_bplus)) return 0;
+
+    // Sem memória para a célula nova o cubo é descartado e as agregações
+    // voltam a varrer a tabela fato
+    if (idx->cube && !aggregate_cube_add_fact(idx->cube, idx->dw, fact_id)) {
+        aggregate_cube_destroy(idx->cube);
+        idx->cube = NULL;
+    }
+
+    // Ano fora do intervalo coberto ou país/tipo novo: as somas são refeitas
+    if (idx->year_sums && !year_sums_add_fact(idx->year_sums, idx->dw, fact_id)) {
+        year_sums_destroy(idx->year_sums);
+        idx->year_sums = year_sums_build(idx->dw);
+    }
+    return 1;
 }
 
 // =============================================================================
-// CONSULTAS SIMPLES
+// PERSISTÊNCIA DOS ÍNDICES
 // =============================================================================
 
-int* index_search_by_country(IndexSystem *idx, const char *country, int *result_count) {
-    if (!idx || !idx->dw || !country || !result_count) return NULL;
+// O manifesto registra para quais dados os arquivos de índice foram gerados.
+// Só é gravado depois que todos os índices foram salvos com sucesso.
+#define INDEX_MANIFEST_FILE "index_manifest.dat"
+#define INDEX_MANIFEST_MAGIC 0x58444e49  // "INDX"
+#define INDEX_MANIFEST_VERSION 1
 
-    *result_count = 0;
+typedef struct {
+    int magic;
+    int version;
+    int fact_count;
+    int trie_mask;      // Bit i ligado: index_trie_files[i] foi salvo
+    int bplus_mask;     // Bit i ligado: index_bplus_files[i] foi salvo
+    int reserved;
+    unsigned long long fingerprint;
+} IndexManifest;
 
-    // Tentar usar índice Trie primeiro
-    if (idx->country_trie) {
-        long *trie_results = trie_search(idx->country_trie, country, result_count);
-        if (trie_results && *result_count > 0) {
-            // Converter long* para int*
-            int *results = malloc(*result_count * sizeof(int));
-            if (results) {
-                for (int i = 0; i < *result_count; i++) {
-                    results[i] = (int)trie_results[i];
-                }
-            }
-            free(trie_results);
-            return results;
-        }
+// FNV-1a de 64 bits
+static unsigned long long index_fingerprint_bytes(unsigned long long hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
     }
+    return hash;
+}
 
-    // Fallback para busca linear
-    int *results = malloc(idx->dw->fact_count * sizeof(int));
-    if (!results) return NULL;
+// Impressão digital dos campos que determinam o conteúdo dos índices: chaves
+// e medidas dos fatos e os atributos indexados de cada dimensão
+static unsigned long long index_compute_fingerprint(DataWarehouse *dw) {
+    unsigned long long hash = 14695981039346656037ULL;
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
+    for (int i = 0; i < dw->fact_count; i++) {
+        DisasterFact *fact = &dw->fact_table[i];
+        int keys[4] = {fact->time_key, fact->geography_key, fact->disaster_type_key, fact->total_deaths};
+        long long measures[2] = {fact->total_affected, fact->total_damage};
+        hash = index_fingerprint_bytes(hash, keys, sizeof(keys));
+        hash = index_fingerprint_bytes(hash, measures, sizeof(measures));
+    }
 
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                    results[(*result_count)++] = i;
-                }
-                break;
-            }
-        }
+    for (int i = 0; i < dw->time_count; i++) {
+        DimTime *time_dim = &dw->dim_time[i];
+        int fields[4] = {time_dim->time_key, time_dim->start_year, time_dim->start_month, time_dim->start_day};
+        hash = index_fingerprint_bytes(hash, fields, sizeof(fields));
     }
 
-    if (*result_count == 0) {
-        free(results);
-        return NULL;
+    for (int i = 0; i < dw->geography_count; i++) {
+        DimGeography *geo_dim = &dw->dim_geography[i];
+        hash = index_fingerprint_bytes(hash, &geo_dim->geography_key, sizeof(int));
+        hash = index_fingerprint_bytes(hash, geo_dim->country, strlen(geo_dim->country) + 1);
+        hash = index_fingerprint_bytes(hash, geo_dim->region, strlen(geo_dim->region) + 1);
+        hash = index_fingerprint_bytes(hash, geo_dim->subregion, strlen(geo_dim->subregion) + 1);
     }
 
-    return results;
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        DimDisasterType *type_dim = &dw->dim_disaster_type[i];
+        hash = index_fingerprint_bytes(hash, &type_dim->disaster_type_key, sizeof(int));
+        hash = index_fingerprint_bytes(hash, type_dim->disaster_type, strlen(type_dim->disaster_type) + 1);
+    }
+
+    return hash;
 }
 
-char** index_search_country_prefix(IndexSystem *idx, const char *prefix, int *result_count) {
-    if (!idx || !idx->dw || !prefix || !result_count) return NULL;
+// Verifica se os arquivos salvos correspondem aos dados atuais e contêm todos
+// os índices habilitados neste sistema
+static bool index_manifest_matches(IndexSystem *idx) {
+    char path[INDEX_PATH_SIZE];
+    index_file_path(idx, INDEX_MANIFEST_FILE, path, sizeof(path));
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
 
-    *result_count = 0;
+    IndexManifest manifest;
+    bool ok = fread(&manifest, sizeof(manifest), 1, file) == 1;
+    fclose(file);
 
-    // Coletar países únicos que começam com o prefixo
-    char **results = malloc(idx->dw->geography_count * sizeof(char*));
-    if (!results) return NULL;
+    if (!ok || manifest.magic != INDEX_MANIFEST_MAGIC ||
+        manifest.version != INDEX_MANIFEST_VERSION ||
+        manifest.fact_count != idx->dw->fact_count) {
+        return false;
+    }
 
-    int prefix_len = strlen(prefix);
+    Trie **trie_slots[INDEX_TRIE_COUNT];
+    BPlusTree **bplus_slots[INDEX_BPLUS_COUNT];
+    index_trie_slots(idx, trie_slots);
+    index_bplus_slots(idx, bplus_slots);
 
-    // Converter prefixo para minúsculo para comparação case-insensitive
-    char prefix_lower[50];
-    strncpy(prefix_lower, prefix, sizeof(prefix_lower) - 1);
-    prefix_lower[sizeof(prefix_lower) - 1] = '\0';
-    for (int i = 0; prefix_lower[i]; i++) {
-        prefix_lower[i] = tolower(prefix_lower[i]);
+    for (int i = 0; i < INDEX_TRIE_COUNT; i++) {
+        if (*trie_slots[i] && !(manifest.trie_mask & (1 << i))) return false;
+    }
+    for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+        if (*bplus_slots[i] && !(manifest.bplus_mask & (1 << i))) return false;
     }
 
-    // Buscar em todas as dimensões geografia
-    for (int i = 0; i < idx->dw->geography_count; i++) {
-        char country_lower[50];
-        strncpy(country_lower, idx->dw->dim_geography[i].country, sizeof(country_lower) - 1);
-        country_lower[sizeof(country_lower) - 1] = '\0';
-
-        // Converter para minúsculo
-        for (int j = 0; country_lower[j]; j++) {
-            country_lower[j] = tolower(country_lower[j]);
-        }
+    return manifest.fingerprint == index_compute_fingerprint(idx->dw);
+}
 
-        // Verificar se começa com o prefixo
-        if (strncmp(country_lower, prefix_lower, prefix_len) == 0) {
-            // Verificar se já não foi adicionado (evitar duplicatas)
-            bool already_added = false;
-            for (int k = 0; k < *result_count; k++) {
-                if (strcmp(results[k], idx->dw->dim_geography[i].country) == 0) {
-                    already_added = true;
-                    break;
-                }
-            }
+// Recalcula os bitmaps a partir da tabela fato (não são persistidos)
+static void index_rebuild_bitmaps(IndexSystem *idx) {
+    if (!idx->bitmaps_enabled) return;
 
-            if (!already_added) {
-                results[*result_count] = malloc(strlen(idx->dw->dim_geography[i].country) + 1);
-                if (results[*result_count]) {
-                    strcpy(results[*result_count], idx->dw->dim_geography[i].country);
-                    (*result_count)++;
-                }
-            }
-        }
+    index_free_bitmaps(idx);
+    for (int i = 0; i < idx->dw->fact_count; i++) {
+        index_bitmaps_add_fact(idx, i);
     }
+    index_optimize_bitmaps(idx);
+}
 
-    if (*result_count == 0) {
+int index_system_save_all(IndexSystem *idx) {
+    if (!idx || !idx->dw) return 0;
+
+    printf("Saving indexes to %s\n", idx->index_base_path);
+    index_ensure_directory(idx);
+
+    Trie **trie_slots[INDEX_TRIE_COUNT];
+    BPlusTree **bplus_slots[INDEX_BPLUS_COUNT];
+    index_trie_slots(idx, trie_slots);
+    index_bplus_slots(idx, bplus_slots);
+
+    IndexManifest manifest;
+    memset(&manifest, 0, sizeof(manifest));
+    manifest.magic = INDEX_MANIFEST_MAGIC;
+    manifest.version = INDEX_MANIFEST_VERSION;
+    manifest.fact_count = idx->dw->fact_count;
+
+    // Remove o manifesto antes de sobrescrever os arquivos: se a gravação for
+    // interrompida, a próxima carga reconstrói em vez de ler arquivos mistos
+    char manifest_path[INDEX_PATH_SIZE];
+    index_file_path(idx, INDEX_MANIFEST_FILE, manifest_path, sizeof(manifest_path));
+    remove(manifest_path);
+
+    // Salvar Tries
+    for (int i = 0; i < INDEX_TRIE_COUNT; i++) {
+        if (!*trie_slots[i]) continue;
+        if (!trie_save_to_file(*trie_slots[i])) return 0;
+        manifest.trie_mask |= 1 << i;
+    }
+
+    // Salvar B+ Trees
+    for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+        if (!*bplus_slots[i]) continue;
+        if (!bplus_save_to_file(*bplus_slots[i])) return 0;
+        manifest.bplus_mask |= 1 << i;
+    }
+
+    manifest.fingerprint = index_compute_fingerprint(idx->dw);
+
+    FILE *file = fopen(manifest_path, "wb");
+    if (!file) return 0;
+    int success = fwrite(&manifest, sizeof(manifest), 1, file) == 1;
+    if (fclose(file) != 0) success = 0;
+
+    return success;
+}
+
+int index_system_load_all(IndexSystem *idx) {
+    if (!idx || !idx->dw) return 0;
+
+    printf("Loading indexes from %s\n", idx->index_base_path);
+
+    if (!index_manifest_matches(idx)) {
+        printf("Index files missing or out of date, rebuilding...\n");
+        if (!index_system_build_all(idx)) return 0;
+        if (!index_system_save_all(idx)) {
+            printf("Warning: Failed to save indexes\n");
+        }
+        return 1;
+    }
+
+    Trie **trie_slots[INDEX_TRIE_COUNT];
+    BPlusTree **bplus_slots[INDEX_BPLUS_COUNT];
+    index_trie_slots(idx, trie_slots);
+    index_bplus_slots(idx, bplus_slots);
+
+    // Carrega tudo em estruturas temporárias; os índices atuais só são
+    // substituídos se todos os arquivos forem lidos com sucesso
+    Trie *loaded_tries[INDEX_TRIE_COUNT] = {NULL};
+    BPlusTree *loaded_trees[INDEX_BPLUS_COUNT] = {NULL};
+    bool ok = true;
+
+    char path[INDEX_PATH_SIZE];
+
+    for (int i = 0; i < INDEX_TRIE_COUNT && ok; i++) {
+        if (!*trie_slots[i]) continue;
+        index_file_path(idx, index_trie_files[i], path, sizeof(path));
+        loaded_tries[i] = trie_load_from_file(path);
+        if (!loaded_tries[i]) ok = false;
+    }
+    for (int i = 0; i < INDEX_BPLUS_COUNT && ok; i++) {
+        if (!*bplus_slots[i]) continue;
+        index_file_path(idx, index_bplus_files[i], path, sizeof(path));
+        loaded_trees[i] = idx->bplus_mapped ? bplus_open_mapped(path) : bplus_load_from_file(path);
+        // Arquivo salvo com outra ordem: reconstruir com a ordem configurada
+        if (!loaded_trees[i] || bplus_get_order(loaded_trees[i]) != bplus_get_order(*bplus_slots[i])) ok = false;
+    }
+
+    if (!ok) {
+        for (int i = 0; i < INDEX_TRIE_COUNT; i++) {
+            if (loaded_tries[i]) trie_destroy(loaded_tries[i]);
+        }
+        for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+            if (loaded_trees[i]) bplus_destroy(loaded_trees[i]);
+        }
+        printf("Failed to read index files, rebuilding...\n");
+        if (!index_system_build_all(idx)) return 0;
+        if (!index_system_save_all(idx)) {
+            printf("Warning: Failed to save indexes\n");
+        }
+        return 1;
+    }
+
+    for (int i = 0; i < INDEX_TRIE_COUNT; i++) {
+        if (!loaded_tries[i]) continue;
+        trie_destroy(*trie_slots[i]);
+        *trie_slots[i] = loaded_tries[i];
+    }
+    for (int i = 0; i < INDEX_BPLUS_COUNT; i++) {
+        if (!loaded_trees[i]) continue;
+        bplus_destroy(*bplus_slots[i]);
+        *bplus_slots[i] = loaded_trees[i];
+    }
+
+    // Bitmaps, cubo e somas por ano não são persistidos: recalculá-los é
+    // uma única varredura
+    index_rebuild_bitmaps(idx);
+    aggregate_cube_destroy(idx->cube);
+    idx->cube = aggregate_cube_build(idx->dw);
+    year_sums_destroy(idx->year_sums);
+    idx->year_sums = year_sums_build(idx->dw);
+
+    idx->indexes_loaded = true;
+    idx->last_rebuild_time = time(NULL);
+    idx->generation = index_next_generation();
+
+    printf("Indexes loaded from disk!\n");
+    return 1;
+}
+
+// =============================================================================
+// CONSULTAS SIMPLES
+// =============================================================================
+
+// Copia a lista de fact_ids emprestada pela Trie para um vetor do chamador.
+// A visão só vale até a próxima inserção, por isso a cópia é feita na hora.
+static int* index_trie_ids(const Trie *trie, const char *key, int *result_count) {
+    const int *ids = trie_search_view(trie, key, result_count);
+    if (!ids) return NULL;
+
+    int *results = malloc(*result_count * sizeof(int));
+    if (!results) {
+        *result_count = 0;
+        return NULL;
+    }
+    memcpy(results, ids, *result_count * sizeof(int));
+    return results;
+}
+
+// Busca por intervalo na B+ Tree convertendo os valores (fact_ids) para int
+static int* index_bplus_range_ids(BPlusTree *tree, long long min_key, long long max_key, int *result_count) {
+    *result_count = 0;
+    if (min_key > max_key) return NULL;
+
+    int count = 0;
+    long *values = bplus_search_range(tree, min_key, max_key, &count);
+    if (!values) return NULL;
+
+    int *results = malloc(count * sizeof(int));
+    if (results) {
+        for (int i = 0; i < count; i++) {
+            results[i] = (int)values[i];
+        }
+        *result_count = count;
+    }
+    free(values);
+    return results;
+}
+
+int* index_search_by_country(IndexSystem *idx, const char *country, int *result_count) {
+    if (!idx || !idx->dw || !country || !result_count) return NULL;
+
+    *result_count = 0;
+
+    // Tentar usar índice Trie primeiro
+    if (idx->country_trie) {
+        int *results = index_trie_ids(idx->country_trie, country, result_count);
+        if (results) return results;
+    }
+
+    // Fallback para busca linear
+    int *results = malloc(idx->dw->fact_count * sizeof(int));
+    if (!results) return NULL;
+
+    int country_code = string_dict_lookup(idx->dw->dictionary, country);
+
+    for (int i = 0; i < idx->dw->fact_count; i++) {
+        DisasterFact *fact = &idx->dw->fact_table[i];
+
+        DimGeography *geo_dim = dw_get_geography(idx->dw, fact->geography_key);
+        if (geo_dim && geo_dim->country_code == country_code) {
+            results[(*result_count)++] = i;
+        }
+    }
+
+    if (*result_count == 0) {
         free(results);
         return NULL;
     }
@@ -645,40 +1118,176 @@ char** index_search_country_prefix(IndexSystem *idx, const char *prefix, int *re
     return results;
 }
 
-int* index_search_by_disaster_type(IndexSystem *idx, const char *disaster_type, int *result_count) {
+// Nome original (não normalizado) que um fato tem em uma Trie de texto
+typedef const char* (*IndexFactLabel)(DataWarehouse *dw, const DisasterFact *fact);
+
+static const char* index_country_label(DataWarehouse *dw, const DisasterFact *fact) {
+    DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
+    return geo_dim ? geo_dim->country : NULL;
+}
+
+static const char* index_disaster_type_label(DataWarehouse *dw, const DisasterFact *fact) {
+    DimDisasterType *type_dim = dw_get_disaster_type(dw, fact->disaster_type_key);
+    return type_dim ? type_dim->disaster_type : NULL;
+}
+
+// Troca cada palavra normalizada da Trie pelo nome original, obtido pelo
+// primeiro fato da palavra
+static void index_display_names(IndexSystem *idx, const Trie *trie, IndexFactLabel label,
+                                char **words, int count) {
+    for (int i = 0; i < count; i++) {
+        int id_count;
+        const int *ids = trie_search_view(trie, words[i], &id_count);
+        if (!ids || ids[0] < 0 || ids[0] >= idx->dw->fact_count) continue;
+
+        const char *original = label(idx->dw, &idx->dw->fact_table[ids[0]]);
+        if (!original) continue;
+
+        char *name = malloc(strlen(original) + 1);
+        if (name) {
+            strcpy(name, original);
+            free(words[i]);
+            words[i] = name;
+        }
+    }
+}
+
+// Busca aproximada em uma Trie de texto, devolvendo os nomes originais na
+// ordem da Trie (menor distância e mais fatos primeiro)
+static char** index_fuzzy_names(IndexSystem *idx, Trie *trie, IndexFactLabel label,
+                                const char *text, int max_distance, int *result_count) {
+    *result_count = 0;
+    if (!trie) return NULL;
+
+    int match_count;
+    TrieFuzzyMatch *matches = trie_search_fuzzy(trie, text, max_distance, &match_count, TRIE_TOP_K);
+    if (!matches) return NULL;
+
+    char **names = malloc(match_count * sizeof(char*));
+    if (!names) {
+        trie_free_fuzzy_matches(matches, match_count);
+        return NULL;
+    }
+
+    // As palavras passam para o vetor de nomes
+    for (int i = 0; i < match_count; i++) {
+        names[i] = matches[i].word;
+        matches[i].word = NULL;
+    }
+    *result_count = match_count;
+    trie_free_fuzzy_matches(matches, match_count);
+
+    index_display_names(idx, trie, label, names, *result_count);
+    return names;
+}
+
+char** index_search_country_fuzzy(IndexSystem *idx, const char *country, int max_distance, int *result_count) {
+    if (!idx || !idx->dw || !country || !result_count) return NULL;
+
+    return index_fuzzy_names(idx, idx->country_trie, index_country_label,
+                             country, max_distance, result_count);
+}
+
+char** index_search_disaster_type_fuzzy(IndexSystem *idx, const char *disaster_type, int max_distance,
+                                        int *result_count) {
     if (!idx || !idx->dw || !disaster_type || !result_count) return NULL;
 
+    return index_fuzzy_names(idx, idx->disaster_type_trie, index_disaster_type_label,
+                             disaster_type, max_distance, result_count);
+}
+
+char** index_search_country_prefix(IndexSystem *idx, const char *prefix, int *result_count) {
+    if (!idx || !idx->dw || !prefix || !result_count) return NULL;
+
     *result_count = 0;
 
-    // Tentar usar índice Trie primeiro
-    if (idx->disaster_type_trie) {
-        long *trie_results = trie_search(idx->disaster_type_trie, disaster_type, result_count);
-        if (trie_results && *result_count > 0) {
-            int *results = malloc(*result_count * sizeof(int));
-            if (results) {
-                for (int i = 0; i < *result_count; i++) {
-                    results[i] = (int)trie_results[i];
+    // Sugestões da Trie: os países com mais desastres primeiro, usando o
+    // ranking guardado nos nós em vez de percorrer a subárvore
+    if (idx->country_trie) {
+        char **suggestions = trie_search_prefix_ranked(idx->country_trie, prefix, result_count, TRIE_TOP_K);
+        if (suggestions) {
+            index_display_names(idx, idx->country_trie, index_country_label, suggestions, *result_count);
+            return suggestions;
+        }
+    }
+
+    // Fallback: coletar países únicos que começam com o prefixo
+    char **results = malloc(idx->dw->geography_count * sizeof(char*));
+    if (!results) return NULL;
+
+    int prefix_len = strlen(prefix);
+
+    // Converter prefixo para minúsculo para comparação case-insensitive
+    char prefix_lower[50];
+    strncpy(prefix_lower, prefix, sizeof(prefix_lower) - 1);
+    prefix_lower[sizeof(prefix_lower) - 1] = '\0';
+    for (int i = 0; prefix_lower[i]; i++) {
+        prefix_lower[i] = tolower(prefix_lower[i]);
+    }
+
+    // Buscar em todas as dimensões geografia
+    for (int i = 0; i < idx->dw->geography_count; i++) {
+        char country_lower[50];
+        strncpy(country_lower, idx->dw->dim_geography[i].country, sizeof(country_lower) - 1);
+        country_lower[sizeof(country_lower) - 1] = '\0';
+
+        // Converter para minúsculo
+        for (int j = 0; country_lower[j]; j++) {
+            country_lower[j] = tolower(country_lower[j]);
+        }
+
+        // Verificar se começa com o prefixo
+        if (strncmp(country_lower, prefix_lower, prefix_len) == 0) {
+            // Verificar se já não foi adicionado (evitar duplicatas)
+            bool already_added = false;
+            for (int k = 0; k < *result_count; k++) {
+                if (strcmp(results[k], idx->dw->dim_geography[i].country) == 0) {
+                    already_added = true;
+                    break;
+                }
+            }
+
+            if (!already_added) {
+                results[*result_count] = malloc(strlen(idx->dw->dim_geography[i].country) + 1);
+                if (results[*result_count]) {
+                    strcpy(results[*result_count], idx->dw->dim_geography[i].country);
+                    (*result_count)++;
                 }
             }
-            free(trie_results);
-            return results;
         }
     }
 
+    if (*result_count == 0) {
+        free(results);
+        return NULL;
+    }
+
+    return results;
+}
+
+int* index_search_by_disaster_type(IndexSystem *idx, const char *disaster_type, int *result_count) {
+    if (!idx || !idx->dw || !disaster_type || !result_count) return NULL;
+
+    *result_count = 0;
+
+    // Tentar usar índice Trie primeiro
+    if (idx->disaster_type_trie) {
+        int *results = index_trie_ids(idx->disaster_type_trie, disaster_type, result_count);
+        if (results) return results;
+    }
+
     // Fallback para busca linear
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
+    int type_code = string_dict_lookup(idx->dw->dictionary, disaster_type);
+
     for (int i = 0; i < idx->dw->fact_count; i++) {
         DisasterFact *fact = &idx->dw->fact_table[i];
 
-        for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-            if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                if (strcmp(idx->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                    results[(*result_count)++] = i;
-                }
-                break;
-            }
+        DimDisasterType *type_dim = dw_get_disaster_type(idx->dw, fact->disaster_type_key);
+        if (type_dim && type_dim->disaster_type_code == type_code) {
+            results[(*result_count)++] = i;
         }
     }
 
@@ -745,13 +1354,9 @@ int* index_search_by_year(IndexSystem *idx, int year, int *result_count) {
     for (int i = 0; i < idx->dw->fact_count; i++) {
         DisasterFact *fact = &idx->dw->fact_table[i];
 
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year == year) {
-                    results[(*result_count)++] = i;
-                }
-                break;
-            }
+        DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+        if (time_dim && time_dim->start_year == year) {
+            results[(*result_count)++] = i;
         }
     }
 
@@ -768,50 +1373,28 @@ int* index_search_by_year_range(IndexSystem *idx, int start_year, int end_year,
 
     *result_count = 0;
 
+    // A B+ Tree guarda todos os fatos de cada ano e percorre o intervalo pelas folhas
+    if (idx->year_bplus && idx->indexes_loaded) {
+        return index_bplus_range_ids(idx->year_bplus, start_year, end_year, result_count);
+    }
+
     // Usar bitmaps se disponíveis para consultas de intervalo
-    if (start_year >= 1970 && end_year < 2170) {
-        int start_index = start_year - 1970;
-        int end_index = end_year - 1970;
-
-        if (start_index >= 0 && end_index < 200) {
-            // Usar operações de bitmap para encontrar união
-            unsigned char *result_bitmap = NULL;
-
-            for (int year_idx = start_index; year_idx <= end_index; year_idx++) {
-                if (idx->year_bitmap[year_idx]) {
-                    if (!result_bitmap) {
-                        result_bitmap = malloc(1000); // 8000 bits
-                        memcpy(result_bitmap, idx->year_bitmap[year_idx], 1000);
-                    } else {
-                        unsigned char *temp = bitmap_or(result_bitmap, idx->year_bitmap[year_idx], 1000);
-                        if (temp) {
-                            free(result_bitmap);
-                            result_bitmap = temp;
-                        }
-                    }
-                }
-            }
+    if (idx->bitmaps_enabled && idx->indexes_loaded && start_year >= 1970 && end_year < 2170) {
+        // União dos bitmaps dos anos do intervalo em uma única passada
+        const RoaringBitmap *years[200];
+        int year_count = 0;
+        for (int year_idx = start_year - 1970; year_idx <= end_year - 1970; year_idx++) {
+            years[year_count++] = &idx->year_bitmap[year_idx];
+        }
 
-            if (result_bitmap) {
-                // Contar bits setados e criar array de resultados
-                int bit_count = bitmap_count_bits(result_bitmap, 1000);
-                if (bit_count > 0) {
-                    int *results = malloc(bit_count * sizeof(int));
-                    if (results) {
-                        int result_idx = 0;
-                        for (int i = 0; i < 8000 && result_idx < bit_count; i++) {
-                            if (bitmap_get_bit(result_bitmap, i)) {
-                                results[result_idx++] = i;
-                            }
-                        }
-                        *result_count = result_idx;
-                        free(result_bitmap);
-                        return results;
-                    }
-                }
-                free(result_bitmap);
-            }
+        RoaringBitmap result_bitmap;
+        roaring_init(&result_bitmap);
+        if (roaring_or_many(&result_bitmap, years, year_count)) {
+            int *results = roaring_to_array(&result_bitmap, result_count);
+            roaring_clear(&result_bitmap);
+            return results;
         }
+        roaring_clear(&result_bitmap);
     }
 
     // Fallback para busca linear
@@ -821,14 +1404,10 @@ int* index_search_by_year_range(IndexSystem *idx, int start_year, int end_year,
     for (int i = 0; i < idx->dw->fact_count; i++) {
         DisasterFact *fact = &idx->dw->fact_table[i];
 
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year >= start_year &&
-                    idx->dw->dim_time[j].start_year <= end_year) {
-                    results[(*result_count)++] = i;
-                }
-                break;
-            }
+        DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+        if (time_dim && time_dim->start_year >= start_year &&
+            time_dim->start_year <= end_year) {
+            results[(*result_count)++] = i;
         }
     }
 
@@ -844,6 +1423,12 @@ int* index_search_by_damage_range(IndexSystem *idx, long long min_damage, long l
     if (!idx || !idx->dw || !result_count) return NULL;
 
     *result_count = 0;
+
+    // A chave da B+ Tree é o valor exato, então o intervalo sai direto do índice
+    if (idx->damage_bplus && idx->indexes_loaded) {
+        return index_bplus_range_ids(idx->damage_bplus, min_damage, max_damage, result_count);
+    }
+
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
@@ -866,6 +1451,12 @@ int* index_search_by_affected_range(IndexSystem *idx, long long min_affected, lo
     if (!idx || !idx->dw || !result_count) return NULL;
 
     *result_count = 0;
+
+    // A chave da B+ Tree é o valor exato, então o intervalo sai direto do índice
+    if (idx->affected_bplus && idx->indexes_loaded) {
+        return index_bplus_range_ids(idx->affected_bplus, min_affected, max_affected, result_count);
+    }
+
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
@@ -888,6 +1479,12 @@ int* index_search_by_deaths_range(IndexSystem *idx, int min_deaths, int max_deat
     if (!idx || !idx->dw || !result_count) return NULL;
 
     *result_count = 0;
+
+    // Tentar usar índice B+ Tree primeiro
+    if (idx->deaths_bplus && idx->indexes_loaded) {
+        return index_bplus_range_ids(idx->deaths_bplus, min_deaths, max_deaths, result_count);
+    }
+
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
@@ -920,55 +1517,24 @@ int* index_search_country_year(IndexSystem *idx, const char *country, int year,
         char composite_key[100];
         snprintf(composite_key, sizeof(composite_key), "%d_%s", year, country);
 
-        long *composite_results = trie_search(idx->year_country_trie, composite_key, result_count);
-        if (composite_results && *result_count > 0) {
-            int *results = malloc(*result_count * sizeof(int));
-            if (results) {
-                for (int i = 0; i < *result_count; i++) {
-                    results[i] = (int)composite_results[i];
-                }
-            }
-            free(composite_results);
-            return results;
-        }
+        int *results = index_trie_ids(idx->year_country_trie, composite_key, result_count);
+        if (results) return results;
     }
 
-    // Fallback: intersecção de resultados individuais
+    // Fallback: intersecção das listas ordenadas de país e de ano
     int country_count = 0, year_count = 0;
     int *country_results = index_search_by_country(idx, country, &country_count);
     int *year_results = index_search_by_year(idx, year, &year_count);
 
-    if (!country_results || !year_results) {
-        free(country_results);
-        free(year_results);
-        return NULL;
-    }
-
-    // Intersecção dos resultados
-    int *results = malloc((country_count < year_count ? country_count : year_count) * sizeof(int));
-    if (!results) {
-        free(country_results);
-        free(year_results);
-        return NULL;
-    }
-
-    for (int i = 0; i < country_count; i++) {
-        for (int j = 0; j < year_count; j++) {
-            if (country_results[i] == year_results[j]) {
-                results[(*result_count)++] = country_results[i];
-                break;
-            }
-        }
+    int *results = NULL;
+    if (country_results && year_results) {
+        country_count = postings_normalize(country_results, country_count);
+        year_count = postings_normalize(year_results, year_count);
+        results = postings_intersect(country_results, country_count, year_results, year_count, result_count);
     }
 
     free(country_results);
     free(year_results);
-
-    if (*result_count == 0) {
-        free(results);
-        return NULL;
-    }
-
     return results;
 }
 
@@ -982,16 +1548,17 @@ int* index_search_disaster_country(IndexSystem *idx, const char *disaster_type,
         char composite_key[100];
         snprintf(composite_key, sizeof(composite_key), "%s_%s", disaster_type, country);
 
-        long *composite_results = trie_search(idx->disaster_country_trie, composite_key, result_count);
-        if (composite_results && *result_count > 0) {
-            int *results = malloc(*result_count * sizeof(int));
-            if (results) {
-                for (int i = 0; i < *result_count; i++) {
-                    results[i] = (int)composite_results[i];
-                }
-            }
-            free(composite_results);
-            return results;
+        int *results = index_trie_ids(idx->disaster_country_trie, composite_key, result_count);
+        if (results) return results;
+    }
+
+    // Intersecção das listas de país e de tipo, lidas direto das Tries
+    if (idx->country_trie && idx->disaster_type_trie) {
+        int country_count = 0, type_count = 0;
+        const int *country_ids = trie_search_view(idx->country_trie, country, &country_count);
+        const int *type_ids = trie_search_view(idx->disaster_type_trie, disaster_type, &type_count);
+        if (country_ids && type_ids) {
+            return postings_intersect(country_ids, country_count, type_ids, type_count, result_count);
         }
     }
 
@@ -999,28 +1566,23 @@ int* index_search_disaster_country(IndexSystem *idx, const char *disaster_type,
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
+    int country_code = string_dict_lookup(idx->dw->dictionary, country);
+    int type_code = string_dict_lookup(idx->dw->dictionary, disaster_type);
+
     for (int i = 0; i < idx->dw->fact_count; i++) {
         DisasterFact *fact = &idx->dw->fact_table[i];
         bool country_match = false, disaster_match = false;
 
         // Verificar país
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                    country_match = true;
-                }
-                break;
-            }
+        DimGeography *geo_dim = dw_get_geography(idx->dw, fact->geography_key);
+        if (geo_dim && geo_dim->country_code == country_code) {
+            country_match = true;
         }
 
         // Verificar tipo de desastre
-        for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-            if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                if (strcmp(idx->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                    disaster_match = true;
-                }
-                break;
-            }
+        DimDisasterType *type_dim = dw_get_disaster_type(idx->dw, fact->disaster_type_key);
+        if (type_dim && type_dim->disaster_type_code == type_code) {
+            disaster_match = true;
         }
 
         if (country_match && disaster_match) {
@@ -1036,10 +1598,61 @@ int* index_search_disaster_country(IndexSystem *idx, const char *disaster_type,
     return results;
 }
 
+// União dos bitmaps das linhas de geografia do país (o mesmo país pode
+// aparecer em mais de uma linha da dimensão)
+static int index_country_bitmap(IndexSystem *idx, int country_code, RoaringBitmap *result) {
+    for (int i = 0; i < idx->dw->geography_count; i++) {
+        int key = idx->dw->dim_geography[i].geography_key;
+        if (idx->dw->dim_geography[i].country_code == country_code &&
+            key >= 0 && key < idx->country_bitmap_count &&
+            !roaring_or_into(result, &idx->country_bitmap[key])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int index_disaster_type_bitmap(IndexSystem *idx, int type_code, RoaringBitmap *result) {
+    for (int i = 0; i < idx->dw->disaster_type_count; i++) {
+        int key = idx->dw->dim_disaster_type[i].disaster_type_key;
+        if (idx->dw->dim_disaster_type[i].disaster_type_code == type_code &&
+            key >= 0 && key < idx->disaster_bitmap_count &&
+            !roaring_or_into(result, &idx->disaster_bitmap[key])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 int* index_search_country_year_disaster(IndexSystem *idx, const char *country, int year, const char *disaster_type, int *result_count) {
     if (!idx || !idx->dw || !country || !disaster_type || !result_count) return NULL;
 
     *result_count = 0;
+
+    int country_code = string_dict_lookup(idx->dw->dictionary, country);
+    int type_code = string_dict_lookup(idx->dw->dictionary, disaster_type);
+    if (country_code < 0 || type_code < 0) return NULL;
+
+    // Intersecção dos bitmaps de país, ano e tipo de desastre
+    if (idx->bitmaps_enabled && idx->indexes_loaded && year >= 1970 && year < 2170) {
+        RoaringBitmap matches, types;
+        roaring_init(&matches);
+        roaring_init(&types);
+
+        if (index_country_bitmap(idx, country_code, &matches) &&
+            index_disaster_type_bitmap(idx, type_code, &types) &&
+            roaring_and_into(&matches, &idx->year_bitmap[year - 1970]) &&
+            roaring_and_into(&matches, &types)) {
+            int *results = roaring_to_array(&matches, result_count);
+            roaring_clear(&matches);
+            roaring_clear(&types);
+            return results;
+        }
+        roaring_clear(&matches);
+        roaring_clear(&types);
+    }
+
+    // Fallback para busca linear
     int *results = malloc(idx->dw->fact_count * sizeof(int));
     if (!results) return NULL;
 
@@ -1048,33 +1661,21 @@ int* index_search_country_year_disaster(IndexSystem *idx, const char *country, i
         bool country_match = false, year_match = false, disaster_match = false;
 
         // Verificar país
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                    country_match = true;
-                }
-                break;
-            }
+        DimGeography *geo_dim = dw_get_geography(idx->dw, fact->geography_key);
+        if (geo_dim && geo_dim->country_code == country_code) {
+            country_match = true;
         }
 
         // Verificar ano
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year == year) {
-                    year_match = true;
-                }
-                break;
-            }
+        DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+        if (time_dim && time_dim->start_year == year) {
+            year_match = true;
         }
 
         // Verificar tipo de desastre
-        for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-            if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                if (strcmp(idx->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                    disaster_match = true;
-                }
-                break;
-            }
+        DimDisasterType *type_dim = dw_get_disaster_type(idx->dw, fact->disaster_type_key);
+        if (type_dim && type_dim->disaster_type_code == type_code) {
+            disaster_match = true;
         }
 
         if (country_match && year_match && disaster_match) {
@@ -1094,44 +1695,107 @@ int* index_search_country_year_disaster(IndexSystem *idx, const char *country, i
 // AGREGAÇÕES
 // =============================================================================
 
-AggregationResult* index_aggregate_by_country(IndexSystem *idx, const char *country) {
-    if (!idx || !idx->dw || !country) return NULL;
+// Filtro aplicado às varreduras da tabela fato. As máscaras são indexadas pela
+// chave substituta (posição 0 representa chave inválida e nunca casa) e valem
+// NULL quando o filtro correspondente não foi informado.
+typedef struct {
+    int start_year;
+    int end_year;
+    unsigned char *geography_mask;
+    unsigned char *disaster_type_mask;
+} FactFilter;
+
+static void fact_filter_init(FactFilter *filter) {
+    filter->start_year = INT_MIN;
+    filter->end_year = INT_MAX;
+    filter->geography_mask = NULL;
+    filter->disaster_type_mask = NULL;
+}
+
+static void fact_filter_release(FactFilter *filter) {
+    free(filter->geography_mask);
+    free(filter->disaster_type_mask);
+}
+
+// Marca as chaves de geografia cujo país é igual ao informado. O país é
+// resolvido no dicionário uma vez e as linhas da dimensão comparam códigos.
+static unsigned char* index_build_country_mask(DataWarehouse *dw, const char *country) {
+    unsigned char *mask = calloc(dw->geography_capacity + 1, sizeof(unsigned char));
+    if (!mask) return NULL;
+
+    int country_code = string_dict_lookup(dw->dictionary, country);
+    if (country_code < 0) return mask;
+
+    for (int i = 0; i < dw->geography_count; i++) {
+        int key = dw->dim_geography[i].geography_key;
+        if (key >= 1 && key <= dw->geography_capacity &&
+            dw->dim_geography[i].country_code == country_code) {
+            mask[key] = 1;
+        }
+    }
+    return mask;
+}
 
-    AggregationResult *result = malloc(sizeof(AggregationResult));
-    if (!result) return NULL;
+static unsigned char* index_build_disaster_type_mask(DataWarehouse *dw, const char *disaster_type) {
+    unsigned char *mask = calloc(dw->disaster_type_capacity + 1, sizeof(unsigned char));
+    if (!mask) return NULL;
+
+    int type_code = string_dict_lookup(dw->dictionary, disaster_type);
+    if (type_code < 0) return mask;
+
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        int key = dw->dim_disaster_type[i].disaster_type_key;
+        if (key >= 1 && key <= dw->disaster_type_capacity &&
+            dw->dim_disaster_type[i].disaster_type_code == type_code) {
+            mask[key] = 1;
+        }
+    }
+    return mask;
+}
+
+// Verifica um fato pelo caminho de linhas (sem armazenamento colunar)
+static bool fact_filter_match_row(DataWarehouse *dw, const FactFilter *filter, int row) {
+    DisasterFact *fact = &dw->fact_table[row];
+    DimTime *time_dim = dw_get_time(dw, fact->time_key);
+    int year = time_dim ? time_dim->start_year : 0;
+
+    if (year < filter->start_year || year > filter->end_year) return false;
+    if (filter->geography_mask) {
+        int key = dw_get_geography(dw, fact->geography_key) ? fact->geography_key : 0;
+        if (!filter->geography_mask[key]) return false;
+    }
+    if (filter->disaster_type_mask) {
+        int key = dw_get_disaster_type(dw, fact->disaster_type_key) ? fact->disaster_type_key : 0;
+        if (!filter->disaster_type_mask[key]) return false;
+    }
+    return true;
+}
 
+static void aggregation_init(AggregationResult *result) {
     memset(result, 0, sizeof(AggregationResult));
     result->min_deaths = LLONG_MAX;
     result->min_affected = LLONG_MAX;
     result->min_damage = LLONG_MAX;
+}
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
+static void aggregation_add(AggregationResult *result, int deaths, long long affected, long long damage) {
+    result->count++;
+    result->total_deaths += deaths;
+    result->total_affected += affected;
+    result->total_damage += damage;
 
-        // Verificar se pertence ao país
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                    result->count++;
-                    result->total_deaths += fact->total_deaths;
-                    result->total_affected += fact->total_affected;
-                    result->total_damage += fact->total_damage;
-
-                    // Máximos
-                    if (fact->total_deaths > result->max_deaths) result->max_deaths = fact->total_deaths;
-                    if (fact->total_affected > result->max_affected) result->max_affected = fact->total_affected;
-                    if (fact->total_damage > result->max_damage) result->max_damage = fact->total_damage;
-
-                    // Mínimos
-                    if (fact->total_deaths < result->min_deaths) result->min_deaths = fact->total_deaths;
-                    if (fact->total_affected < result->min_affected) result->min_affected = fact->total_affected;
-                    if (fact->total_damage < result->min_damage) result->min_damage = fact->total_damage;
-                }
-                break;
-            }
-        }
-    }
+    // Máximos
+    if (deaths > result->max_deaths) result->max_deaths = deaths;
+    if (affected > result->max_affected) result->max_affected = affected;
+    if (damage > result->max_damage) result->max_damage = damage;
+
+    // Mínimos
+    if (deaths < result->min_deaths) result->min_deaths = deaths;
+    if (affected < result->min_affected) result->min_affected = affected;
+    if (damage < result->min_damage) result->min_damage = damage;
+}
 
+static void aggregation_finish(AggregationResult *result) {
     if (result->count > 0) {
         result->avg_deaths = (double)result->total_deaths / result->count;
         result->avg_affected = (double)result->total_affected / result->count;
@@ -1141,195 +1805,769 @@ AggregationResult* index_aggregate_by_country(IndexSystem *idx, const char *coun
         result->min_affected = 0;
         result->min_damage = 0;
     }
-
-    return result;
 }
 
-AggregationResult* index_aggregate_by_year(IndexSystem *idx, int year) {
-    if (!idx || !idx->dw) return NULL;
-
+// Agrega todos os fatos que satisfazem o filtro. Com o armazenamento colunar
+// a varredura percorre apenas arrays contíguos de inteiros.
+static AggregationResult* index_aggregate_filtered(DataWarehouse *dw, const FactFilter *filter) {
     AggregationResult *result = malloc(sizeof(AggregationResult));
     if (!result) return NULL;
 
-    memset(result, 0, sizeof(AggregationResult));
-    result->min_deaths = LLONG_MAX;
-    result->min_affected = LLONG_MAX;
-    result->min_damage = LLONG_MAX;
+    aggregation_init(result);
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
+    if (dw->columns) {
+        const FactColumns *columns = dw->columns;
+        const int *years = columns->start_year;
+        const int *geography_keys = columns->geography_key;
+        const int *type_keys = columns->disaster_type_key;
+        const unsigned char *geography_mask = filter->geography_mask;
+        const unsigned char *type_mask = filter->disaster_type_mask;
 
-        // Verificar se pertence ao ano
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year == year) {
-                    result->count++;
-                    result->total_deaths += fact->total_deaths;
-                    result->total_affected += fact->total_affected;
-                    result->total_damage += fact->total_damage;
-
-                    // Máximos
-                    if (fact->total_deaths > result->max_deaths) result->max_deaths = fact->total_deaths;
-                    if (fact->total_affected > result->max_affected) result->max_affected = fact->total_affected;
-                    if (fact->total_damage > result->max_damage) result->max_damage = fact->total_damage;
-
-                    // Mínimos
-                    if (fact->total_deaths < result->min_deaths) result->min_deaths = fact->total_deaths;
-                    if (fact->total_affected < result->min_affected) result->min_affected = fact->total_affected;
-                    if (fact->total_damage < result->min_damage) result->min_damage = fact->total_damage;
-                }
-                break;
+        for (int i = 0; i < columns->count; i++) {
+            if (years[i] < filter->start_year || years[i] > filter->end_year) continue;
+            if (geography_mask && !geography_mask[geography_keys[i]]) continue;
+            if (type_mask && !type_mask[type_keys[i]]) continue;
+
+            aggregation_add(result, columns->total_deaths[i],
+                            columns->total_affected[i], columns->total_damage[i]);
+        }
+    } else {
+        for (int i = 0; i < dw->fact_count; i++) {
+            if (fact_filter_match_row(dw, filter, i)) {
+                DisasterFact *fact = &dw->fact_table[i];
+                aggregation_add(result, fact->total_deaths, fact->total_affected, fact->total_damage);
             }
         }
     }
 
-    if (result->count > 0) {
-        result->avg_deaths = (double)result->total_deaths / result->count;
-        result->avg_affected = (double)result->total_affected / result->count;
-        result->avg_damage = (double)result->total_damage / result->count;
+    aggregation_finish(result);
+    return result;
+}
+
+// Retorna as posições na tabela fato que satisfazem o filtro
+static int* index_collect_filtered(DataWarehouse *dw, const FactFilter *filter, int *result_count) {
+    *result_count = 0;
+    int *results = malloc(dw->fact_count * sizeof(int));
+    if (!results) return NULL;
+
+    if (dw->columns) {
+        const FactColumns *columns = dw->columns;
+        const int *years = columns->start_year;
+        const int *geography_keys = columns->geography_key;
+        const int *type_keys = columns->disaster_type_key;
+        const unsigned char *geography_mask = filter->geography_mask;
+        const unsigned char *type_mask = filter->disaster_type_mask;
+
+        for (int i = 0; i < columns->count; i++) {
+            if (years[i] < filter->start_year || years[i] > filter->end_year) continue;
+            if (geography_mask && !geography_mask[geography_keys[i]]) continue;
+            if (type_mask && !type_mask[type_keys[i]]) continue;
+            results[(*result_count)++] = i;
+        }
     } else {
-        result->min_deaths = 0;
-        result->min_affected = 0;
-        result->min_damage = 0;
+        for (int i = 0; i < dw->fact_count; i++) {
+            if (fact_filter_match_row(dw, filter, i)) {
+                results[(*result_count)++] = i;
+            }
+        }
+    }
+
+    if (*result_count == 0) {
+        free(results);
+        return NULL;
+    }
+
+    return results;
+}
+
+// =============================================================================
+// CUBO DE AGREGAÇÕES
+// =============================================================================
+//
+// Uma célula por combinação (ano, geography_key, disaster_type_key) presente
+// na tabela fato, com contagem, somas, mínimos e máximos. Para cada
+// subconjunto das três dimensões há uma tabela com as células já somadas nas
+// dimensões de fora (rollup): uma consulta lê a tabela exatamente das
+// dimensões que filtra e percorre só as células que passam no filtro, em vez
+// de todos os fatos.
+
+#define CUBE_YEAR 1
+#define CUBE_GEOGRAPHY 2
+#define CUBE_DISASTER_TYPE 4
+#define CUBE_TABLES 8
+
+typedef struct {
+    int key[3];                 // Ano, geography_key, disaster_type_key (0 nas dimensões somadas)
+    AggregationResult stats;
+} CubeCell;
+
+typedef struct {
+    CubeCell *cells;            // Em ordem de key (o ano primeiro) até sorted_count
+    int count;
+    int capacity;
+    int sorted_count;           // Células depois desta posição foram inseridas
+                                // incrementalmente e ainda não foram mescladas
+} CubeTable;
+
+struct AggregateCube {
+    CubeTable tables[CUBE_TABLES];  // Índice = dimensões mantidas (CUBE_*)
+};
+
+// Fato da posição row pela chave do cubo (dimensões ausentes viram 0, como
+// nas colunas)
+typedef struct {
+    int key[3];
+    int row;
+} CubeEntry;
+
+static void aggregation_merge(AggregationResult *result, const AggregationResult *other) {
+    result->count += other->count;
+    result->total_deaths += other->total_deaths;
+    result->total_affected += other->total_affected;
+    result->total_damage += other->total_damage;
+
+    if (other->max_deaths > result->max_deaths) result->max_deaths = other->max_deaths;
+    if (other->max_affected > result->max_affected) result->max_affected = other->max_affected;
+    if (other->max_damage > result->max_damage) result->max_damage = other->max_damage;
+
+    if (other->min_deaths < result->min_deaths) result->min_deaths = other->min_deaths;
+    if (other->min_affected < result->min_affected) result->min_affected = other->min_affected;
+    if (other->min_damage < result->min_damage) result->min_damage = other->min_damage;
+}
+
+static int cube_compare_keys(const int *a, const int *b) {
+    for (int d = 0; d < 3; d++) {
+        if (a[d] != b[d]) return a[d] < b[d] ? -1 : 1;
+    }
+    return 0;
+}
+
+static int cube_compare_entries(const void *a, const void *b) {
+    return cube_compare_keys(((const CubeEntry *)a)->key, ((const CubeEntry *)b)->key);
+}
+
+static int cube_compare_cells(const void *a, const void *b) {
+    return cube_compare_keys(((const CubeCell *)a)->key, ((const CubeCell *)b)->key);
+}
+
+static void cube_fact_key(DataWarehouse *dw, int row, int key[3]) {
+    if (dw->columns && row < dw->columns->count) {
+        key[0] = dw->columns->start_year[row];
+        key[1] = dw->columns->geography_key[row];
+        key[2] = dw->columns->disaster_type_key[row];
+        return;
+    }
+
+    DisasterFact *fact = &dw->fact_table[row];
+    DimTime *time_dim = dw_get_time(dw, fact->time_key);
+    key[0] = time_dim ? time_dim->start_year : 0;
+    key[1] = dw_get_geography(dw, fact->geography_key) ? fact->geography_key : 0;
+    key[2] = dw_get_disaster_type(dw, fact->disaster_type_key) ? fact->disaster_type_key : 0;
+}
+
+static void cube_add_row(AggregationResult *stats, DataWarehouse *dw, int row) {
+    DisasterFact *fact = &dw->fact_table[row];
+    aggregation_add(stats, fact->total_deaths, fact->total_affected, fact->total_damage);
+}
+
+// Chave da célula na tabela: só as dimensões mantidas
+static void cube_project_key(const int *key, int dims, int *projected) {
+    projected[0] = (dims & CUBE_YEAR) ? key[0] : 0;
+    projected[1] = (dims & CUBE_GEOGRAPHY) ? key[1] : 0;
+    projected[2] = (dims & CUBE_DISASTER_TYPE) ? key[2] : 0;
+}
+
+// Junta células consecutivas de mesma chave (o vetor já está ordenado)
+static int cube_merge_sorted(CubeCell *cells, int count) {
+    if (count == 0) return 0;
+
+    int n = 1;
+    for (int i = 1; i < count; i++) {
+        if (cube_compare_keys(cells[i].key, cells[n - 1].key) == 0) {
+            aggregation_merge(&cells[n - 1].stats, &cells[i].stats);
+        } else {
+            cells[n++] = cells[i];
+        }
     }
+    return n;
+}
+
+static void cube_table_shrink(CubeTable *table) {
+    if (table->count == 0) return;
+
+    CubeCell *cells = realloc(table->cells, table->count * sizeof(CubeCell));
+    if (cells) {
+        table->cells = cells;
+        table->capacity = table->count;
+    }
+}
+
+static void aggregate_cube_destroy(AggregateCube *cube) {
+    if (!cube) return;
+
+    for (int t = 0; t < CUBE_TABLES; t++) {
+        free(cube->tables[t].cells);
+    }
+    free(cube);
+}
+
+// Constrói o cubo com uma ordenação dos fatos pela chave completa; os rollups
+// saem das células completas, que são bem menos numerosas que os fatos
+static AggregateCube* aggregate_cube_build(DataWarehouse *dw) {
+    AggregateCube *cube = calloc(1, sizeof(AggregateCube));
+    if (!cube) return NULL;
+
+    int fact_count = dw->fact_count;
+    CubeEntry *entries = malloc((fact_count > 0 ? fact_count : 1) * sizeof(CubeEntry));
+    CubeTable *full = &cube->tables[CUBE_YEAR | CUBE_GEOGRAPHY | CUBE_DISASTER_TYPE];
+    full->cells = malloc((fact_count > 0 ? fact_count : 1) * sizeof(CubeCell));
+    if (!entries || !full->cells) {
+        free(entries);
+        aggregate_cube_destroy(cube);
+        return NULL;
+    }
+
+    for (int i = 0; i < fact_count; i++) {
+        cube_fact_key(dw, i, entries[i].key);
+        entries[i].row = i;
+    }
+    qsort(entries, fact_count, sizeof(CubeEntry), cube_compare_entries);
 
+    for (int i = 0; i < fact_count; i++) {
+        if (full->count == 0 || cube_compare_keys(entries[i].key, full->cells[full->count - 1].key) != 0) {
+            CubeCell *cell = &full->cells[full->count++];
+            memcpy(cell->key, entries[i].key, sizeof(cell->key));
+            aggregation_init(&cell->stats);
+        }
+        cube_add_row(&full->cells[full->count - 1].stats, dw, entries[i].row);
+    }
+    free(entries);
+    full->capacity = fact_count > 0 ? fact_count : 1;
+    full->sorted_count = full->count;
+    cube_table_shrink(full);
+
+    for (int dims = 0; dims < CUBE_TABLES - 1; dims++) {
+        CubeTable *table = &cube->tables[dims];
+        table->cells = malloc((full->count > 0 ? full->count : 1) * sizeof(CubeCell));
+        if (!table->cells) {
+            aggregate_cube_destroy(cube);
+            return NULL;
+        }
+
+        for (int i = 0; i < full->count; i++) {
+            table->cells[i] = full->cells[i];
+            cube_project_key(full->cells[i].key, dims, table->cells[i].key);
+        }
+        qsort(table->cells, full->count, sizeof(CubeCell), cube_compare_cells);
+        table->count = cube_merge_sorted(table->cells, full->count);
+        table->sorted_count = table->count;
+        table->capacity = full->count > 0 ? full->count : 1;
+        cube_table_shrink(table);
+    }
+
+    return cube;
+}
+
+// Primeira célula da parte ordenada da tabela com chave >= key
+static int cube_table_position(const CubeTable *table, const int *key) {
+    int low = 0, high = table->sorted_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (cube_compare_keys(table->cells[mid].key, key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Acrescenta um fato novo a todas as tabelas do cubo. Célula existente é
+// atualizada no lugar (busca binária); combinação nova vai para o fim da
+// tabela, sem deslocar as demais, e só é mesclada na próxima consulta.
+static int aggregate_cube_add_fact(AggregateCube *cube, DataWarehouse *dw, int row) {
+    int key[3];
+    cube_fact_key(dw, row, key);
+
+    for (int dims = 0; dims < CUBE_TABLES; dims++) {
+        CubeTable *table = &cube->tables[dims];
+        int projected[3];
+        cube_project_key(key, dims, projected);
+
+        int pos = cube_table_position(table, projected);
+        if (pos == table->sorted_count || cube_compare_keys(table->cells[pos].key, projected) != 0) {
+            if (table->count == table->capacity) {
+                int capacity = table->capacity > 0 ? table->capacity * 2 : 16;
+                CubeCell *cells = realloc(table->cells, capacity * sizeof(CubeCell));
+                if (!cells) return 0;
+                table->cells = cells;
+                table->capacity = capacity;
+            }
+            pos = table->count++;
+            memcpy(table->cells[pos].key, projected, sizeof(projected));
+            aggregation_init(&table->cells[pos].stats);
+        }
+        cube_add_row(&table->cells[pos].stats, dw, row);
+    }
+    return 1;
+}
+
+// Mescla as células inseridas incrementalmente na parte ordenada. As chaves
+// delas não existem na parte ordenada (senão o fato teria sido somado lá),
+// então basta ordenar o fim, juntar repetidas e intercalar as duas partes.
+static void cube_table_merge_pending(CubeTable *table) {
+    if (table->sorted_count == table->count) return;
+
+    CubeCell *pending = &table->cells[table->sorted_count];
+    int pending_count = table->count - table->sorted_count;
+    qsort(pending, pending_count, sizeof(CubeCell), cube_compare_cells);
+    pending_count = cube_merge_sorted(pending, pending_count);
+    table->count = table->sorted_count + pending_count;
+
+    // Intercalação de trás para frente com cópia só das células novas; sem
+    // memória para a cópia, ordena a tabela inteira
+    CubeCell *copy = malloc(pending_count * sizeof(CubeCell));
+    if (!copy) {
+        qsort(table->cells, table->count, sizeof(CubeCell), cube_compare_cells);
+        table->sorted_count = table->count;
+        return;
+    }
+    memcpy(copy, pending, pending_count * sizeof(CubeCell));
+
+    int i = table->sorted_count - 1;
+    int j = pending_count - 1;
+    for (int out = table->count - 1; j >= 0; out--) {
+        if (i >= 0 && cube_compare_keys(table->cells[i].key, copy[j].key) > 0) {
+            table->cells[out] = table->cells[i--];
+        } else {
+            table->cells[out] = copy[j--];
+        }
+    }
+    free(copy);
+    table->sorted_count = table->count;
+}
+
+// Responde o filtro pela tabela das dimensões filtradas. Com ano, as células
+// do intervalo são contíguas (o ano é a primeira chave da ordenação).
+static AggregationResult* aggregate_cube_query(AggregateCube *cube, const FactFilter *filter) {
+    bool by_year = filter->start_year != INT_MIN || filter->end_year != INT_MAX;
+    int dims = (by_year ? CUBE_YEAR : 0) |
+               (filter->geography_mask ? CUBE_GEOGRAPHY : 0) |
+               (filter->disaster_type_mask ? CUBE_DISASTER_TYPE : 0);
+    CubeTable *table = &cube->tables[dims];
+    cube_table_merge_pending(table);
+
+    AggregationResult *result = malloc(sizeof(AggregationResult));
+    if (!result) return NULL;
+    aggregation_init(result);
+
+    int first = 0;
+    if (by_year) {
+        int start[3] = {filter->start_year, INT_MIN, INT_MIN};
+        first = cube_table_position(table, start);
+    }
+
+    for (int i = first; i < table->count; i++) {
+        const CubeCell *cell = &table->cells[i];
+        if (by_year && cell->key[0] > filter->end_year) break;
+        if (filter->geography_mask && !filter->geography_mask[cell->key[1]]) continue;
+        if (filter->disaster_type_mask && !filter->disaster_type_mask[cell->key[2]]) continue;
+
+        aggregation_merge(result, &cell->stats);
+    }
+
+    aggregation_finish(result);
     return result;
 }
 
+// Agregação pelo cubo quando ele existe; senão varre a tabela fato
+static AggregationResult* index_aggregate(IndexSystem *idx, const FactFilter *filter) {
+    if (idx->cube) return aggregate_cube_query(idx->cube, filter);
+    return index_aggregate_filtered(idx->dw, filter);
+}
+
+AggregationResult* index_aggregate_by_country(IndexSystem *idx, const char *country) {
+    if (!idx || !idx->dw || !country) return NULL;
+
+    FactFilter filter;
+    fact_filter_init(&filter);
+    filter.geography_mask = index_build_country_mask(idx->dw, country);
+    if (!filter.geography_mask) return NULL;
+
+    AggregationResult *result = index_aggregate(idx, &filter);
+    fact_filter_release(&filter);
+    return result;
+}
+
+AggregationResult* index_aggregate_by_year(IndexSystem *idx, int year) {
+    if (!idx || !idx->dw) return NULL;
+
+    FactFilter filter;
+    fact_filter_init(&filter);
+    filter.start_year = year;
+    filter.end_year = year;
+
+    return index_aggregate(idx, &filter);
+}
+
 AggregationResult* index_aggregate_by_disaster_type(IndexSystem *idx, const char *disaster_type) {
     if (!idx || !idx->dw || !disaster_type) return NULL;
 
-    AggregationResult *result = malloc(sizeof(AggregationResult));
-    if (!result) return NULL;
+    FactFilter filter;
+    fact_filter_init(&filter);
+    filter.disaster_type_mask = index_build_disaster_type_mask(idx->dw, disaster_type);
+    if (!filter.disaster_type_mask) return NULL;
 
-    memset(result, 0, sizeof(AggregationResult));
-    result->min_deaths = LLONG_MAX;
-    result->min_affected = LLONG_MAX;
-    result->min_damage = LLONG_MAX;
+    AggregationResult *result = index_aggregate(idx, &filter);
+    fact_filter_release(&filter);
+    return result;
+}
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
+AggregationResult* index_aggregate_multi_dimension(IndexSystem *idx, const char *country,
+                                                 int year, const char *disaster_type) {
+    if (!idx || !idx->dw) return NULL;
+
+    FactFilter filter;
+    fact_filter_init(&filter);
+
+    // Verificar ano se especificado
+    if (year > 0) {
+        filter.start_year = year;
+        filter.end_year = year;
+    }
+
+    // Verificar país e tipo de desastre se especificados
+    if (country != NULL) {
+        filter.geography_mask = index_build_country_mask(idx->dw, country);
+    }
+    if (disaster_type != NULL) {
+        filter.disaster_type_mask = index_build_disaster_type_mask(idx->dw, disaster_type);
+    }
+
+    if ((country && !filter.geography_mask) || (disaster_type && !filter.disaster_type_mask)) {
+        fact_filter_release(&filter);
+        return NULL;
+    }
+
+    AggregationResult *result = index_aggregate(idx, &filter);
+    fact_filter_release(&filter);
+    return result;
+}
+
+// =============================================================================
+// SOMAS ACUMULADAS POR ANO
+// =============================================================================
+//
+// Uma série por membro (total geral, cada país e cada tipo de desastre) com a
+// contagem e as somas de mortes, afetados e danos acumuladas ano a ano. O
+// total de [start_year, end_year] é serie[fim + 1] - serie[início], qualquer
+// que seja a quantidade de fatos no intervalo. Mínimos e máximos não se
+// subtraem: os do total geral ficam numa sparse table em que o nível k guarda
+// os extremos de cada bloco de 2^k anos, e qualquer intervalo é coberto por
+// dois blocos sobrepostos.
+
+typedef struct {
+    long long max_deaths;
+    long long max_affected;
+    long long max_damage;
+    long long min_deaths;
+    long long min_affected;
+    long long min_damage;
+} YearExtremes;
+
+struct YearPrefixSums {
+    int first_year;
+    int year_count;
+    int code_count;                 // Códigos do dicionário cobertos pelos mapas abaixo
+    int *country_series;            // country_code -> série (-1 = país sem fatos)
+    int *type_series;               // disaster_type_code -> série (-1 = tipo sem fatos)
+    int series_count;               // Série 0 = total geral
+    YearRangeTotals *sums;          // series_count séries de year_count + 1 posições
+    int levels;
+    YearExtremes *extremes;         // levels níveis de year_count posições
+};
+
+// Ano, país e tipo (códigos do dicionário, -1 = dimensão inválida) do fato
+static void year_sums_fact_members(DataWarehouse *dw, int row, int *year, int *country_code, int *type_code) {
+    int key[3];
+    cube_fact_key(dw, row, key);
+    *year = key[0];
+
+    DimGeography *geo = dw_get_geography(dw, key[1]);
+    DimDisasterType *type = dw_get_disaster_type(dw, key[2]);
+    *country_code = geo ? geo->country_code : -1;
+    *type_code = type ? type->disaster_type_code : -1;
+}
+
+static YearRangeTotals* year_sums_series(const YearPrefixSums *sums, int series) {
+    return &sums->sums[(size_t)series * (sums->year_count + 1)];
+}
+
+static void year_totals_add_fact(YearRangeTotals *totals, const DisasterFact *fact) {
+    totals->count++;
+    totals->total_deaths += fact->total_deaths;
+    totals->total_affected += fact->total_affected;
+    totals->total_damage += fact->total_damage;
+}
+
+static void year_extremes_init(YearExtremes *extremes) {
+    extremes->max_deaths = 0;
+    extremes->max_affected = 0;
+    extremes->max_damage = 0;
+    extremes->min_deaths = LLONG_MAX;
+    extremes->min_affected = LLONG_MAX;
+    extremes->min_damage = LLONG_MAX;
+}
+
+static void year_extremes_fact(YearExtremes *extremes, const DisasterFact *fact) {
+    extremes->max_deaths = extremes->min_deaths = fact->total_deaths;
+    extremes->max_affected = extremes->min_affected = fact->total_affected;
+    extremes->max_damage = extremes->min_damage = fact->total_damage;
+}
+
+static void year_extremes_merge(YearExtremes *extremes, const YearExtremes *other) {
+    if (other->max_deaths > extremes->max_deaths) extremes->max_deaths = other->max_deaths;
+    if (other->max_affected > extremes->max_affected) extremes->max_affected = other->max_affected;
+    if (other->max_damage > extremes->max_damage) extremes->max_damage = other->max_damage;
+
+    if (other->min_deaths < extremes->min_deaths) extremes->min_deaths = other->min_deaths;
+    if (other->min_affected < extremes->min_affected) extremes->min_affected = other->min_affected;
+    if (other->min_damage < extremes->min_damage) extremes->min_damage = other->min_damage;
+}
+
+static void year_sums_destroy(YearPrefixSums *sums) {
+    if (!sums) return;
+
+    free(sums->country_series);
+    free(sums->type_series);
+    free(sums->sums);
+    free(sums->extremes);
+    free(sums);
+}
+
+// Duas varreduras dos fatos: a primeira acha o intervalo de anos e cria uma
+// série por país e por tipo presentes, a segunda soma cada fato no seu ano
+static YearPrefixSums* year_sums_build(DataWarehouse *dw) {
+    YearPrefixSums *sums = calloc(1, sizeof(YearPrefixSums));
+    if (!sums) return NULL;
+
+    int fact_count = dw->fact_count;
+    int code_count = string_dict_count(dw->dictionary);
+    sums->code_count = code_count;
+    sums->country_series = malloc((code_count > 0 ? code_count : 1) * sizeof(int));
+    sums->type_series = malloc((code_count > 0 ? code_count : 1) * sizeof(int));
+    if (!sums->country_series || !sums->type_series) {
+        year_sums_destroy(sums);
+        return NULL;
+    }
+    for (int code = 0; code < code_count; code++) {
+        sums->country_series[code] = -1;
+        sums->type_series[code] = -1;
+    }
+
+    int min_year = INT_MAX, max_year = INT_MIN;
+    sums->series_count = 1;
+    for (int i = 0; i < fact_count; i++) {
+        int year, country_code, type_code;
+        year_sums_fact_members(dw, i, &year, &country_code, &type_code);
+
+        if (year < min_year) min_year = year;
+        if (year > max_year) max_year = year;
+        if (country_code >= 0 && country_code < code_count && sums->country_series[country_code] < 0) {
+            sums->country_series[country_code] = sums->series_count++;
+        }
+        if (type_code >= 0 && type_code < code_count && sums->type_series[type_code] < 0) {
+            sums->type_series[type_code] = sums->series_count++;
+        }
+    }
+
+    int years = fact_count > 0 ? max_year - min_year + 1 : 0;
+    sums->first_year = fact_count > 0 ? min_year : 0;
+    sums->year_count = years;
+    while ((1 << sums->levels) <= years) {
+        sums->levels++;
+    }
+
+    sums->sums = calloc((size_t)sums->series_count * (years + 1), sizeof(YearRangeTotals));
+    sums->extremes = calloc(sums->levels > 0 ? (size_t)sums->levels * years : 1, sizeof(YearExtremes));
+    if (!sums->sums || !sums->extremes) {
+        year_sums_destroy(sums);
+        return NULL;
+    }
+    for (int i = 0; i < years; i++) {
+        year_extremes_init(&sums->extremes[i]);
+    }
+
+    // Totais de cada ano na posição ano - first_year + 1, acumulados depois
+    for (int i = 0; i < fact_count; i++) {
+        int year, country_code, type_code;
+        year_sums_fact_members(dw, i, &year, &country_code, &type_code);
+        const DisasterFact *fact = &dw->fact_table[i];
+        int pos = year - sums->first_year;
+
+        year_totals_add_fact(&year_sums_series(sums, 0)[pos + 1], fact);
+        if (country_code >= 0 && country_code < code_count) {
+            year_totals_add_fact(&year_sums_series(sums, sums->country_series[country_code])[pos + 1], fact);
+        }
+        if (type_code >= 0 && type_code < code_count) {
+            year_totals_add_fact(&year_sums_series(sums, sums->type_series[type_code])[pos + 1], fact);
+        }
+
+        YearExtremes extremes;
+        year_extremes_fact(&extremes, fact);
+        year_extremes_merge(&sums->extremes[pos], &extremes);
+    }
+
+    for (int s = 0; s < sums->series_count; s++) {
+        YearRangeTotals *series = year_sums_series(sums, s);
+        for (int i = 1; i <= years; i++) {
+            series[i].count += series[i - 1].count;
+            series[i].total_deaths += series[i - 1].total_deaths;
+            series[i].total_affected += series[i - 1].total_affected;
+            series[i].total_damage += series[i - 1].total_damage;
+        }
+    }
+
+    // Nível k a partir de dois blocos vizinhos do nível k - 1
+    for (int k = 1; k < sums->levels; k++) {
+        const YearExtremes *previous = &sums->extremes[(size_t)(k - 1) * years];
+        YearExtremes *level = &sums->extremes[(size_t)k * years];
+        int half = 1 << (k - 1);
+        for (int i = 0; i + 2 * half <= years; i++) {
+            level[i] = previous[i];
+            year_extremes_merge(&level[i], &previous[i + half]);
+        }
+    }
+
+    return sums;
+}
+
+// Acrescenta um fato novo às séries: O(anos cobertos). Retorna 0 se o ano
+// está fora do intervalo coberto ou o país/tipo ainda não tem série; nesses
+// casos as somas precisam ser reconstruídas.
+static int year_sums_add_fact(YearPrefixSums *sums, DataWarehouse *dw, int row) {
+    int year, country_code, type_code;
+    year_sums_fact_members(dw, row, &year, &country_code, &type_code);
+    if (year < sums->first_year || year - sums->first_year >= sums->year_count) return 0;
 
-        // Verificar se pertence ao tipo de desastre
-        for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-            if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                if (strcmp(idx->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                    result->count++;
-                    result->total_deaths += fact->total_deaths;
-                    result->total_affected += fact->total_affected;
-                    result->total_damage += fact->total_damage;
-
-                    // Máximos
-                    if (fact->total_deaths > result->max_deaths) result->max_deaths = fact->total_deaths;
-                    if (fact->total_affected > result->max_affected) result->max_affected = fact->total_affected;
-                    if (fact->total_damage > result->max_damage) result->max_damage = fact->total_damage;
-
-                    // Mínimos
-                    if (fact->total_deaths < result->min_deaths) result->min_deaths = fact->total_deaths;
-                    if (fact->total_affected < result->min_affected) result->min_affected = fact->total_affected;
-                    if (fact->total_damage < result->min_damage) result->min_damage = fact->total_damage;
-                }
-                break;
-            }
-        }
+    int series[3] = {0, -1, -1};
+    if (country_code >= 0) {
+        if (country_code >= sums->code_count || sums->country_series[country_code] < 0) return 0;
+        series[1] = sums->country_series[country_code];
+    }
+    if (type_code >= 0) {
+        if (type_code >= sums->code_count || sums->type_series[type_code] < 0) return 0;
+        series[2] = sums->type_series[type_code];
     }
 
-    if (result->count > 0) {
-        result->avg_deaths = (double)result->total_deaths / result->count;
-        result->avg_affected = (double)result->total_affected / result->count;
-        result->avg_damage = (double)result->total_damage / result->count;
-    } else {
-        result->min_deaths = 0;
-        result->min_affected = 0;
-        result->min_damage = 0;
+    const DisasterFact *fact = &dw->fact_table[row];
+    int pos = year - sums->first_year;
+    for (int s = 0; s < 3; s++) {
+        if (series[s] < 0) continue;
+        YearRangeTotals *totals = year_sums_series(sums, series[s]);
+        for (int i = pos + 1; i <= sums->year_count; i++) {
+            year_totals_add_fact(&totals[i], fact);
+        }
     }
 
-    return result;
+    // Blocos de cada nível que contêm o ano
+    YearExtremes extremes;
+    year_extremes_fact(&extremes, fact);
+    for (int k = 0; k < sums->levels; k++) {
+        YearExtremes *level = &sums->extremes[(size_t)k * sums->year_count];
+        int size = 1 << k;
+        int from = pos - size + 1 > 0 ? pos - size + 1 : 0;
+        int to = pos < sums->year_count - size ? pos : sums->year_count - size;
+        for (int i = from; i <= to; i++) {
+            year_extremes_merge(&level[i], &extremes);
+        }
+    }
+    return 1;
 }
 
-AggregationResult* index_aggregate_multi_dimension(IndexSystem *idx, const char *country,
-                                                 int year, const char *disaster_type) {
-    if (!idx || !idx->dw) return NULL;
+// Posições [first, last] do intervalo de anos nas séries; false se vazio
+static bool year_sums_clamp(const YearPrefixSums *sums, int start_year, int end_year, int *first, int *last) {
+    if (sums->year_count == 0) return false;
 
-    AggregationResult *result = malloc(sizeof(AggregationResult));
-    if (!result) return NULL;
+    int last_year = sums->first_year + sums->year_count - 1;
+    if (start_year < sums->first_year) start_year = sums->first_year;
+    if (end_year > last_year) end_year = last_year;
+    if (start_year > end_year) return false;
 
-    memset(result, 0, sizeof(AggregationResult));
-    result->min_deaths = LLONG_MAX;
-    result->min_affected = LLONG_MAX;
-    result->min_damage = LLONG_MAX;
+    *first = start_year - sums->first_year;
+    *last = end_year - sums->first_year;
+    return true;
+}
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
-        bool country_match = (country == NULL);
-        bool year_match = (year <= 0);
-        bool disaster_match = (disaster_type == NULL);
-
-        // Verificar país se especificado
-        if (country != NULL) {
-            for (int j = 0; j < idx->dw->geography_count; j++) {
-                if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                    if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                        country_match = true;
-                    }
-                    break;
-                }
-            }
-        }
+static void year_sums_range(const YearPrefixSums *sums, int series, int first, int last, YearRangeTotals *totals) {
+    const YearRangeTotals *values = year_sums_series(sums, series);
+    totals->count = values[last + 1].count - values[first].count;
+    totals->total_deaths = values[last + 1].total_deaths - values[first].total_deaths;
+    totals->total_affected = values[last + 1].total_affected - values[first].total_affected;
+    totals->total_damage = values[last + 1].total_damage - values[first].total_damage;
+}
 
-        // Verificar ano se especificado
-        if (year > 0) {
-            for (int j = 0; j < idx->dw->time_count; j++) {
-                if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                    if (idx->dw->dim_time[j].start_year == year) {
-                        year_match = true;
-                    }
-                    break;
-                }
-            }
-        }
+// Maior bloco 2^k que cabe no intervalo, no início e no fim
+static void year_sums_range_extremes(const YearPrefixSums *sums, int first, int last, YearExtremes *extremes) {
+    int k = 0;
+    while ((2 << k) <= last - first + 1) {
+        k++;
+    }
 
-        // Verificar tipo de desastre se especificado
-        if (disaster_type != NULL) {
-            for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-                if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                    if (strcmp(idx->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                        disaster_match = true;
-                    }
-                    break;
-                }
-            }
-        }
+    const YearExtremes *level = &sums->extremes[(size_t)k * sums->year_count];
+    *extremes = level[first];
+    year_extremes_merge(extremes, &level[last - (1 << k) + 1]);
+}
 
-        if (country_match && year_match && disaster_match) {
-            result->count++;
-            result->total_deaths += fact->total_deaths;
-            result->total_affected += fact->total_affected;
-            result->total_damage += fact->total_damage;
+static AggregationResult* year_sums_aggregate(const YearPrefixSums *sums, int start_year, int end_year) {
+    AggregationResult *result = malloc(sizeof(AggregationResult));
+    if (!result) return NULL;
+    aggregation_init(result);
+
+    int first, last;
+    if (year_sums_clamp(sums, start_year, end_year, &first, &last)) {
+        YearRangeTotals totals;
+        YearExtremes extremes;
+        year_sums_range(sums, 0, first, last, &totals);
+        year_sums_range_extremes(sums, first, last, &extremes);
+
+        result->count = totals.count;
+        result->total_deaths = totals.total_deaths;
+        result->total_affected = totals.total_affected;
+        result->total_damage = totals.total_damage;
+        result->max_deaths = extremes.max_deaths;
+        result->max_affected = extremes.max_affected;
+        result->max_damage = extremes.max_damage;
+        result->min_deaths = extremes.min_deaths;
+        result->min_affected = extremes.min_affected;
+        result->min_damage = extremes.min_damage;
+    }
+
+    aggregation_finish(result);
+    return result;
+}
 
-            // Máximos
-            if (fact->total_deaths > result->max_deaths) result->max_deaths = fact->total_deaths;
-            if (fact->total_affected > result->max_affected) result->max_affected = fact->total_affected;
-            if (fact->total_damage > result->max_damage) result->max_damage = fact->total_damage;
+int index_year_range_totals(IndexSystem *idx, int country_code, int disaster_type_code,
+                            int start_year, int end_year, YearRangeTotals *totals) {
+    if (!idx || !idx->year_sums || !totals) return 0;
+    if (country_code >= 0 && disaster_type_code >= 0) return 0;
 
-            // Mínimos
-            if (fact->total_deaths < result->min_deaths) result->min_deaths = fact->total_deaths;
-            if (fact->total_affected < result->min_affected) result->min_affected = fact->total_affected;
-            if (fact->total_damage < result->min_damage) result->min_damage = fact->total_damage;
-        }
-    }
+    const YearPrefixSums *sums = idx->year_sums;
+    memset(totals, 0, sizeof(YearRangeTotals));
 
-    if (result->count > 0) {
-        result->avg_deaths = (double)result->total_deaths / result->count;
-        result->avg_affected = (double)result->total_affected / result->count;
-        result->avg_damage = (double)result->total_damage / result->count;
-    } else {
-        result->min_deaths = 0;
-        result->min_affected = 0;
-        result->min_damage = 0;
+    int series = 0;
+    if (country_code >= 0) {
+        series = country_code < sums->code_count ? sums->country_series[country_code] : -1;
+    } else if (disaster_type_code >= 0) {
+        series = disaster_type_code < sums->code_count ? sums->type_series[disaster_type_code] : -1;
     }
 
-    return result;
+    // Membro sem série não tem fatos: totais zerados
+    int first, last;
+    if (series >= 0 && year_sums_clamp(sums, start_year, end_year, &first, &last)) {
+        year_sums_range(sums, series, first, last, totals);
+    }
+    return 1;
 }
 
 // =============================================================================
@@ -1365,7 +2603,7 @@ OptimizedDataWarehouse* optimized_dw_create_with_config(IndexConfiguration *conf
     }
 
     // Criar sistema de cache
-    odw->cache = cache_system_create(config->max_cache_age);
+    odw->cache = cache_system_create(config->cache_size, config->cache_memory);
     if (!odw->cache) {
         index_system_destroy(odw->indexes);
         dw_destroy(odw->dw);
@@ -1430,6 +2668,111 @@ int optimized_dw_save(OptimizedDataWarehouse *odw, const char *base_path) {
     return 1;
 }
 
+// Compara o texto de uma consulta com o nome do fato como a Trie compara:
+// sem diferenciar maiúsculas e com '_' equivalente a espaço
+static bool index_same_label(const char *text, size_t length, const char *label) {
+    size_t i = 0;
+    for (; i < length && label[i]; i++) {
+        char a = tolower((unsigned char)text[i]);
+        char b = tolower((unsigned char)label[i]);
+        if (a == '_') a = ' ';
+        if (b == '_') b = ' ';
+        if (a != b) return false;
+    }
+    return i == length && label[i] == '\0';
+}
+
+// Fato recém-inserido, visto pelas chaves de cache
+typedef struct {
+    const char *country;        // NULL se o fato não tem geografia
+    int year;
+} CacheFactChange;
+
+// As listas em cache guardam posições de fatos, que não mudam com inserções:
+// uma consulta só fica desatualizada se o fato novo entra no seu resultado
+static bool optimized_cache_depends_on_fact(const char *query_key, void *context) {
+    const CacheFactChange *change = context;
+
+    if (strncmp(query_key, "country:", 8) == 0) {
+        const char *country = query_key + 8;
+        return change->country && index_same_label(country, strlen(country), change->country);
+    }
+
+    if (strncmp(query_key, "country_year_range:", 19) == 0) {
+        // country_year_range:<país>:<início>:<fim>, o país pode conter ':'
+        const char *country = query_key + 19;
+        const char *end_sep = strrchr(country, ':');
+        const char *start_sep = end_sep;
+        while (start_sep > country && *(start_sep - 1) != ':') {
+            start_sep--;
+        }
+        if (!end_sep || start_sep == country) return true;
+        start_sep--;
+
+        int start_year = atoi(start_sep + 1);
+        int end_year = atoi(end_sep + 1);
+        return change->country && change->year >= start_year && change->year <= end_year &&
+               index_same_label(country, start_sep - country, change->country);
+    }
+
+    // Chave desconhecida: descartar é sempre seguro
+    return true;
+}
+
+// Alinha o cache com a geração dos índices. Qualquer mudança que não passou
+// por optimized_dw_apply_insert (reconstrução, carga, inserção direta nos
+// índices) descarta todas as entradas.
+static void optimized_cache_sync(OptimizedDataWarehouse *odw) {
+    if (odw->indexes) cache_set_generation(odw->cache, odw->indexes->generation);
+}
+
+// Atualiza índices e cache para o fato da posição row, recém-acrescentado
+static int optimized_dw_apply_insert(OptimizedDataWarehouse *odw, int row) {
+    DataWarehouse *dw = odw->dw;
+    if (!odw->indexes) return row;
+
+    optimized_cache_sync(odw);
+    if (!index_system_insert_entry(odw->indexes, row)) {
+        printf("Warning: Incremental indexing of fact %d failed, rebuilding\n", row);
+        index_system_rebuild(odw->indexes);
+        optimized_cache_sync(odw);
+        return row;
+    }
+
+    // Só as consultas que passam a incluir o fato são removidas; as demais
+    // continuam valendo na geração nova
+    DisasterFact *fact = &dw->fact_table[row];
+    DimTime *time_dim = dw_get_time(dw, fact->time_key);
+    DimGeography *geo_dim = dw_get_geography(dw, fact->geography_key);
+
+    CacheFactChange change;
+    change.country = geo_dim ? geo_dim->country : NULL;
+    change.year = time_dim ? time_dim->start_year : 0;
+    cache_invalidate_matching(odw->cache, optimized_cache_depends_on_fact, &change);
+    cache_advance_generation(odw->cache, odw->indexes->generation);
+
+    return row;
+}
+
+int optimized_dw_insert_fact(OptimizedDataWarehouse *odw, int time_key, int geography_key,
+                             int disaster_type_key, int total_deaths,
+                             long long total_affected, long long total_damage) {
+    if (!odw || !odw->dw) return -1;
+
+    if (dw_insert_fact(odw->dw, time_key, geography_key, disaster_type_key,
+                       total_deaths, total_affected, total_damage) == -1) {
+        return -1;
+    }
+    return optimized_dw_apply_insert(odw, odw->dw->fact_count - 1);
+}
+
+int optimized_dw_insert_original(OptimizedDataWarehouse *odw, OriginalDisaster *original) {
+    if (!odw || !odw->dw || !original) return -1;
+
+    if (!dw_convert_from_original(odw->dw, original)) return -1;
+    return optimized_dw_apply_insert(odw, odw->dw->fact_count - 1);
+}
+
 int* optimized_query_by_country(OptimizedDataWarehouse *odw, const char *country, int *result_count) {
     if (!odw || !country || !result_count) return NULL;
 
@@ -1437,6 +2780,7 @@ int* optimized_query_by_country(OptimizedDataWarehouse *odw, const char *country
     char cache_key[256];
     snprintf(cache_key, sizeof(cache_key), "country:%s", country);
 
+    optimized_cache_sync(odw);
     int *cached_results = cache_search(odw->cache, cache_key, result_count);
     if (cached_results) {
         return cached_results;
@@ -1461,6 +2805,33 @@ AggregationResult* optimized_aggregate_query(OptimizedDataWarehouse *odw,
     return index_aggregate_multi_dimension(odw->indexes, country, year, disaster_type);
 }
 
+int* optimized_query_by_country_fuzzy(OptimizedDataWarehouse *odw, const char *country,
+                                      char *resolved, int resolved_size, int *result_count) {
+    if (!odw || !country || !result_count) return NULL;
+
+    *result_count = 0;
+
+    // Textos curtos aceitam só uma edição para não casar com qualquer país
+    int max_distance = strlen(country) <= 4 ? 1 : 2;
+
+    int candidate_count = 0;
+    char **candidates = index_search_country_fuzzy(odw->indexes, country, max_distance, &candidate_count);
+    if (!candidates) return NULL;
+
+    int *results = optimized_query_by_country(odw, candidates[0], result_count);
+    if (results && resolved && resolved_size > 0) {
+        strncpy(resolved, candidates[0], resolved_size - 1);
+        resolved[resolved_size - 1] = '\0';
+    }
+
+    for (int i = 0; i < candidate_count; i++) {
+        free(candidates[i]);
+    }
+    free(candidates);
+
+    return results;
+}
+
 char** optimized_autocomplete_country(OptimizedDataWarehouse *odw, const char *prefix, int *result_count) {
     if (!odw || !prefix || !result_count) return NULL;
 
@@ -1503,18 +2874,50 @@ void index_print_statistics(IndexSystem *idx) {
 
     printf("Bitmap Indexes:\n");
     int year_bitmaps = 0, country_bitmaps = 0, disaster_bitmaps = 0;
+    size_t bitmap_bytes = 0;
     for (int i = 0; i < 200; i++) {
-        if (idx->year_bitmap[i]) year_bitmaps++;
-    }
-    for (int i = 0; i < 250; i++) {
-        if (idx->country_bitmap[i]) country_bitmaps++;
-    }
-    for (int i = 0; i < 100; i++) {
-        if (idx->disaster_bitmap[i]) disaster_bitmaps++;
+        if (idx->year_bitmap[i].count > 0) year_bitmaps++;
+        bitmap_bytes += roaring_memory(&idx->year_bitmap[i]);
+    }
+    for (int i = 0; i < idx->country_bitmap_count; i++) {
+        if (idx->country_bitmap[i].count > 0) country_bitmaps++;
+        bitmap_bytes += roaring_memory(&idx->country_bitmap[i]);
+    }
+    for (int i = 0; i < idx->disaster_bitmap_count; i++) {
+        if (idx->disaster_bitmap[i].count > 0) disaster_bitmaps++;
+        bitmap_bytes += roaring_memory(&idx->disaster_bitmap[i]);
+    }
+    printf("  Year bitmaps: %d\n", year_bitmaps);
+    printf("  Geography bitmaps: %d\n", country_bitmaps);
+    printf("  Disaster type bitmaps: %d\n", disaster_bitmaps);
+    printf("  Bitmap memory: %zu bytes\n", bitmap_bytes);
+
+    printf("Aggregate Cube:\n");
+    if (idx->cube) {
+        CubeTable *full = &idx->cube->tables[CUBE_YEAR | CUBE_GEOGRAPHY | CUBE_DISASTER_TYPE];
+        cube_table_merge_pending(full);
+        size_t cube_bytes = 0;
+        for (int t = 0; t < CUBE_TABLES; t++) {
+            cube_bytes += idx->cube->tables[t].capacity * sizeof(CubeCell);
+        }
+        printf("  Cells (year x geography x type): %d\n", full->count);
+        printf("  Cube memory: %zu bytes\n", cube_bytes);
+    } else {
+        printf("  Not built\n");
+    }
+
+    printf("Year Prefix Sums:\n");
+    if (idx->year_sums) {
+        const YearPrefixSums *sums = idx->year_sums;
+        size_t sums_bytes = (size_t)sums->series_count * (sums->year_count + 1) * sizeof(YearRangeTotals) +
+                            (size_t)sums->levels * sums->year_count * sizeof(YearExtremes) +
+                            2 * (size_t)sums->code_count * sizeof(int);
+        printf("  Years: %d-%d\n", sums->first_year, sums->first_year + sums->year_count - 1);
+        printf("  Series (overall + countries + types): %d\n", sums->series_count);
+        printf("  Prefix sums memory: %zu bytes\n", sums_bytes);
+    } else {
+        printf("  Not built\n");
     }
-    printf("  Year bitmaps: %d/200\n", year_bitmaps);
-    printf("  Country bitmaps: %d/250\n", country_bitmaps);
-    printf("  Disaster bitmaps: %d/100\n", disaster_bitmaps);
 
     printf("Composite Indexes:\n");
     printf("  Year-Country Trie: %s\n", idx->year_country_trie ? "Initialized" : "NULL");
@@ -1539,28 +2942,9 @@ int index_verify_integrity(IndexSystem *idx) {
     for (int i = 0; i < idx->dw->fact_count; i++) {
         DisasterFact *fact = &idx->dw->fact_table[i];
 
-        bool time_found = false, geo_found = false, type_found = false;
-
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                time_found = true;
-                break;
-            }
-        }
-
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                geo_found = true;
-                break;
-            }
-        }
-
-        for (int j = 0; j < idx->dw->disaster_type_count; j++) {
-            if (idx->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                type_found = true;
-                break;
-            }
-        }
+        bool time_found = dw_get_time(idx->dw, fact->time_key) != NULL;
+        bool geo_found = dw_get_geography(idx->dw, fact->geography_key) != NULL;
+        bool type_found = dw_get_disaster_type(idx->dw, fact->disaster_type_key) != NULL;
 
         if (!time_found || !geo_found || !type_found) {
             invalid_refs++;
@@ -1608,7 +2992,7 @@ void optimized_dw_print_statistics(OptimizedDataWarehouse *odw) {
         printf("  Composite indexes: %s\n", odw->config->enable_composite_indexes ? "Enabled" : "Disabled");
         printf("  Auto rebuild: %s\n", odw->config->auto_rebuild ? "Enabled" : "Disabled");
         printf("  Cache size: %d\n", odw->config->cache_size);
-        printf("  Max cache age: %d seconds\n", odw->config->max_cache_age);
+        printf("  Cache memory: %zu bytes\n", odw->config->cache_memory);
         printf("  Index directory: %s\n", odw->config->index_directory);
     }
 }
@@ -1646,45 +3030,312 @@ int* index_search_country_year_range(IndexSystem *idx, const char *country, int
 
     *result_count = 0;
 
-    // Buscar todos os anos no intervalo para o país
-    int *results = malloc(idx->dw->fact_count * sizeof(int));
-    if (!results) return NULL;
+    // Varredura única com o país resolvido para chaves de geografia
+    FactFilter filter;
+    fact_filter_init(&filter);
+    filter.start_year = start_year;
+    filter.end_year = end_year;
+    filter.geography_mask = index_build_country_mask(idx->dw, country);
+    if (!filter.geography_mask) return NULL;
 
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
-        bool country_match = false, year_match = false;
+    int *results = index_collect_filtered(idx->dw, &filter, result_count);
+    fact_filter_release(&filter);
+    return results;
+}
 
-        // Verificar país
-        for (int j = 0; j < idx->dw->geography_count; j++) {
-            if (idx->dw->dim_geography[j].geography_key == fact->geography_key) {
-                if (strcmp(idx->dw->dim_geography[j].country, country) == 0) {
-                    country_match = true;
-                }
-                break;
-            }
+// =============================================================================
+// PLANEJADOR DE CONSULTAS COM VÁRIOS FILTROS
+// =============================================================================
+//
+// Cada filtro vira um predicado cujo conjunto de fatos é a união de alguns
+// bitmaps (linhas da dimensão com o país ou o tipo, ou anos do intervalo).
+// Como cada fato tem uma única chave por dimensão esses bitmaps são disjuntos,
+// então a soma das cardinalidades é o número exato de fatos do predicado e sai
+// sem tocar a tabela fato. O plano parte do predicado mais seletivo e, para
+// cada um dos seguintes, escolhe entre intersectar seus bitmaps ou verificar
+// os candidatos que sobraram direto nas dimensões.
+
+// Custo relativo do plano: intersectar um predicado custa cerca de uma
+// operação a cada INDEX_PLAN_BITMAP_RATIO fatos dele (vetores e bitsets tratam
+// vários fatos por operação) e verificar um candidato nas dimensões custa uma
+#define INDEX_PLAN_BITMAP_RATIO 16
+
+typedef enum {
+    INDEX_PREDICATE_COUNTRY,
+    INDEX_PREDICATE_DISASTER_TYPE,
+    INDEX_PREDICATE_YEAR
+} IndexPredicateKind;
+
+typedef struct {
+    IndexPredicateKind kind;
+    int code;                        // Código do país/tipo no dicionário
+    int start_year;
+    int end_year;
+    const RoaringBitmap **bitmaps;   // Fatos do predicado = união destes bitmaps
+    int bitmap_count;
+    RoaringBitmap postings;          // País fora do dicionário: fatos achados pela Trie
+    int estimate;                    // Fatos do predicado (-1 = sem bitmaps)
+} IndexPredicate;
+
+static bool index_bitmaps_ready(IndexSystem *idx) {
+    return idx->bitmaps_enabled && idx->indexes_loaded;
+}
+
+// Acrescenta um bitmap ao predicado (os vazios não entram na união)
+static void index_predicate_add_bitmap(IndexPredicate *p, const RoaringBitmap *bitmap) {
+    int cardinality = roaring_cardinality(bitmap);
+    if (cardinality == 0) return;
+
+    p->bitmaps[p->bitmap_count++] = bitmap;
+    p->estimate += cardinality;
+}
+
+static int index_plan_country(IndexSystem *idx, const char *country, IndexPredicate *p) {
+    DataWarehouse *dw = idx->dw;
+    p->kind = INDEX_PREDICATE_COUNTRY;
+    p->code = string_dict_lookup(dw->dictionary, country);
+
+    if (p->code < 0) {
+        // Grafia diferente da armazenada: a Trie normaliza o nome
+        p->estimate = 0;
+        int count = 0;
+        const int *ids = idx->country_trie ? trie_search_view(idx->country_trie, country, &count) : NULL;
+        if (!ids) return 1;
+
+        p->bitmaps = malloc(sizeof(RoaringBitmap*));
+        if (!p->bitmaps) return 0;
+        for (int i = 0; i < count; i++) {
+            if (!roaring_add(&p->postings, ids[i])) return 0;
         }
+        index_predicate_add_bitmap(p, &p->postings);
+        return 1;
+    }
 
-        // Verificar intervalo de anos
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year >= start_year &&
-                    idx->dw->dim_time[j].start_year <= end_year) {
-                    year_match = true;
-                }
-                break;
-            }
+    if (!index_bitmaps_ready(idx)) {
+        p->estimate = -1;
+        return 1;
+    }
+
+    p->estimate = 0;
+    p->bitmaps = malloc((dw->geography_count > 0 ? dw->geography_count : 1) * sizeof(RoaringBitmap*));
+    if (!p->bitmaps) return 0;
+
+    for (int i = 0; i < dw->geography_count; i++) {
+        int key = dw->dim_geography[i].geography_key;
+        if (dw->dim_geography[i].country_code == p->code && key >= 0 && key < idx->country_bitmap_count) {
+            index_predicate_add_bitmap(p, &idx->country_bitmap[key]);
         }
+    }
+    return 1;
+}
 
-        if (country_match && year_match) {
-            results[(*result_count)++] = i;
+static int index_plan_disaster_type(IndexSystem *idx, const char *disaster_type, IndexPredicate *p) {
+    DataWarehouse *dw = idx->dw;
+    p->kind = INDEX_PREDICATE_DISASTER_TYPE;
+    p->code = string_dict_lookup(dw->dictionary, disaster_type);
+
+    if (p->code < 0) {
+        p->estimate = 0;
+        return 1;
+    }
+    if (!index_bitmaps_ready(idx)) {
+        p->estimate = -1;
+        return 1;
+    }
+
+    p->estimate = 0;
+    p->bitmaps = malloc((dw->disaster_type_count > 0 ? dw->disaster_type_count : 1) * sizeof(RoaringBitmap*));
+    if (!p->bitmaps) return 0;
+
+    for (int i = 0; i < dw->disaster_type_count; i++) {
+        int key = dw->dim_disaster_type[i].disaster_type_key;
+        if (dw->dim_disaster_type[i].disaster_type_code == p->code && key >= 0 && key < idx->disaster_bitmap_count) {
+            index_predicate_add_bitmap(p, &idx->disaster_bitmap[key]);
+        }
+    }
+    return 1;
+}
+
+static int index_plan_year_range(IndexSystem *idx, int start_year, int end_year, IndexPredicate *p) {
+    p->kind = INDEX_PREDICATE_YEAR;
+    p->start_year = start_year;
+    p->end_year = end_year;
+
+    // Anos fora de 1970-2169 não têm bitmap: o intervalo só é verificado
+    if (!index_bitmaps_ready(idx) || start_year < 1970 || end_year >= 2170) {
+        p->estimate = -1;
+        return 1;
+    }
+
+    p->estimate = 0;
+    p->bitmaps = malloc((end_year - start_year + 1) * sizeof(RoaringBitmap*));
+    if (!p->bitmaps) return 0;
+
+    for (int year = start_year; year <= end_year; year++) {
+        index_predicate_add_bitmap(p, &idx->year_bitmap[year - 1970]);
+    }
+    return 1;
+}
+
+// Verifica um candidato contra o predicado pelas dimensões do fato
+static bool index_predicate_match(IndexSystem *idx, const IndexPredicate *p, int fact_id) {
+    DisasterFact *fact = &idx->dw->fact_table[fact_id];
+
+    switch (p->kind) {
+        case INDEX_PREDICATE_COUNTRY: {
+            if (p->code < 0) return roaring_contains(&p->postings, fact_id);
+            DimGeography *geo_dim = dw_get_geography(idx->dw, fact->geography_key);
+            return geo_dim && geo_dim->country_code == p->code;
+        }
+        case INDEX_PREDICATE_DISASTER_TYPE: {
+            DimDisasterType *type_dim = dw_get_disaster_type(idx->dw, fact->disaster_type_key);
+            return type_dim && type_dim->disaster_type_code == p->code;
         }
+        default: {
+            DimTime *time_dim = dw_get_time(idx->dw, fact->time_key);
+            return time_dim && time_dim->start_year >= p->start_year && time_dim->start_year <= p->end_year;
+        }
+    }
+}
+
+// Conjunto de fatos do predicado (a união é feita só quando há mais de um bitmap)
+static int index_predicate_and_into(RoaringBitmap *target, const IndexPredicate *p) {
+    if (p->bitmap_count == 1) return roaring_and_into(target, p->bitmaps[0]);
+
+    RoaringBitmap matches;
+    roaring_init(&matches);
+    int success = roaring_or_many(&matches, p->bitmaps, p->bitmap_count) &&
+                  roaring_and_into(target, &matches);
+    roaring_clear(&matches);
+    return success;
+}
+
+// Executa o plano: semente no predicado mais seletivo, intersecções enquanto
+// forem mais baratas que verificar os candidatos, verificação no resto
+static int* index_execute_plan(IndexSystem *idx, IndexPredicate **order, int count, int *result_count) {
+    RoaringBitmap candidates;
+    roaring_init(&candidates);
+
+    if (!roaring_or_many(&candidates, order[0]->bitmaps, order[0]->bitmap_count)) {
+        roaring_clear(&candidates);
+        return NULL;
+    }
+
+    int next = 1;
+    for (; next < count; next++) {
+        const IndexPredicate *p = order[next];
+        int candidate_count = roaring_cardinality(&candidates);
+        if (candidate_count == 0) break;
+        if (p->estimate < 0 || candidate_count <= p->estimate / INDEX_PLAN_BITMAP_RATIO) break;
+
+        if (!index_predicate_and_into(&candidates, p)) {
+            roaring_clear(&candidates);
+            return NULL;
+        }
+    }
+
+    int *results = roaring_to_array(&candidates, result_count);
+    roaring_clear(&candidates);
+    if (!results) return NULL;
+
+    // Predicados restantes verificados nos candidatos
+    if (next < count) {
+        int kept = 0;
+        for (int i = 0; i < *result_count; i++) {
+            bool match = true;
+            for (int k = next; k < count && match; k++) {
+                match = index_predicate_match(idx, order[k], results[i]);
+            }
+            if (match) results[kept++] = results[i];
+        }
+        *result_count = kept;
     }
 
     if (*result_count == 0) {
         free(results);
         return NULL;
     }
+    return results;
+}
+
+int* index_search_with_filters(IndexSystem *idx, const char *country, const char *disaster_type,
+                               int start_year, int end_year, int *result_count) {
+    if (!idx || !idx->dw || !result_count) return NULL;
+
+    *result_count = 0;
+
+    bool has_country = country && country[0] != '\0';
+    bool has_type = disaster_type && disaster_type[0] != '\0';
+    bool has_years = start_year > 0 && end_year > 0;
+    if (has_years && start_year > end_year) return NULL;
+
+    // Sem filtros: todos os fatos
+    if (!has_country && !has_type && !has_years) {
+        int *results = malloc((idx->dw->fact_count > 0 ? idx->dw->fact_count : 1) * sizeof(int));
+        if (!results) return NULL;
+        for (int i = 0; i < idx->dw->fact_count; i++) {
+            results[i] = i;
+        }
+        *result_count = idx->dw->fact_count;
+        return results;
+    }
+
+    // Só o intervalo de anos: a B+ Tree percorre o intervalo pelas folhas
+    if (!has_country && !has_type) {
+        return index_search_by_year_range(idx, start_year, end_year, result_count);
+    }
+
+    IndexPredicate predicates[3];
+    IndexPredicate *order[3];
+    int count = 0;
+    int success = 1;
+    memset(predicates, 0, sizeof(predicates));
+
+    if (has_country) success &= index_plan_country(idx, country, &predicates[count++]);
+    if (has_type) success &= index_plan_disaster_type(idx, disaster_type, &predicates[count++]);
+    if (has_years) success &= index_plan_year_range(idx, start_year, end_year, &predicates[count++]);
+
+    // Ordem: predicados com bitmaps do menor para o maior, os sem bitmaps por último
+    bool empty = false;
+    for (int i = 0; i < count; i++) {
+        IndexPredicate *p = &predicates[i];
+        if (p->estimate == 0) empty = true;
+
+        int pos = i;
+        while (pos > 0 && (order[pos - 1]->estimate < 0 ||
+                           (p->estimate >= 0 && p->estimate < order[pos - 1]->estimate))) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = p;
+    }
+
+    int *results = NULL;
+    if (success && !empty) {
+        if (order[0]->estimate > 0) {
+            results = index_execute_plan(idx, order, count, result_count);
+        } else {
+            // Nenhum predicado tem bitmaps: varredura única pelas colunas
+            FactFilter filter;
+            fact_filter_init(&filter);
+            if (has_years) {
+                filter.start_year = start_year;
+                filter.end_year = end_year;
+            }
+            if (has_country) filter.geography_mask = index_build_country_mask(idx->dw, country);
+            if (has_type) filter.disaster_type_mask = index_build_disaster_type_mask(idx->dw, disaster_type);
+
+            if ((!has_country || filter.geography_mask) && (!has_type || filter.disaster_type_mask)) {
+                results = index_collect_filtered(idx->dw, &filter, result_count);
+            }
+            fact_filter_release(&filter);
+        }
+    }
 
+    for (int i = 0; i < count; i++) {
+        free(predicates[i].bitmaps);
+        roaring_clear(&predicates[i].postings);
+    }
     return results;
 }
 
@@ -1709,22 +3360,8 @@ int* index_sort_facts_by_affected(IndexSystem *idx, int *fact_ids, int fact_coun
             sort_data[i].sort_value = idx->dw->fact_table[fact_id].total_affected;
 
             // Preencher dados auxiliares
-            DimTime *time_dim = NULL;
-            DimGeography *geo_dim = NULL;
-
-            for (int j = 0; j < idx->dw->time_count; j++) {
-                if (idx->dw->dim_time[j].time_key == idx->dw->fact_table[fact_id].time_key) {
-                    time_dim = &idx->dw->dim_time[j];
-                    break;
-                }
-            }
-
-            for (int j = 0; j < idx->dw->geography_count; j++) {
-                if (idx->dw->dim_geography[j].geography_key == idx->dw->fact_table[fact_id].geography_key) {
-                    geo_dim = &idx->dw->dim_geography[j];
-                    break;
-                }
-            }
+            DimTime *time_dim = dw_get_time(idx->dw, idx->dw->fact_table[fact_id].time_key);
+            DimGeography *geo_dim = dw_get_geography(idx->dw, idx->dw->fact_table[fact_id].geography_key);
 
             sort_data[i].year = time_dim ? time_dim->start_year : 0;
             strncpy(sort_data[i].country, geo_dim ? geo_dim->country : "Unknown",
@@ -1876,53 +3513,15 @@ int* index_get_sorted_countries_by_affected(IndexSystem *idx, int *country_ids,
 AggregationResult* index_aggregate_by_year_range(IndexSystem *idx, int start_year, int end_year) {
     if (!idx || !idx->dw || start_year > end_year) return NULL;
 
-    AggregationResult *result = malloc(sizeof(AggregationResult));
-    if (!result) return NULL;
-
-    memset(result, 0, sizeof(AggregationResult));
-    result->min_deaths = LLONG_MAX;
-    result->min_affected = LLONG_MAX;
-    result->min_damage = LLONG_MAX;
-
-    for (int i = 0; i < idx->dw->fact_count; i++) {
-        DisasterFact *fact = &idx->dw->fact_table[i];
-
-        // Verificar se pertence ao intervalo de anos
-        for (int j = 0; j < idx->dw->time_count; j++) {
-            if (idx->dw->dim_time[j].time_key == fact->time_key) {
-                if (idx->dw->dim_time[j].start_year >= start_year &&
-                    idx->dw->dim_time[j].start_year <= end_year) {
-                    result->count++;
-                    result->total_deaths += fact->total_deaths;
-                    result->total_affected += fact->total_affected;
-                    result->total_damage += fact->total_damage;
-
-                    // Máximos
-                    if (fact->total_deaths > result->max_deaths) result->max_deaths = fact->total_deaths;
-                    if (fact->total_affected > result->max_affected) result->max_affected = fact->total_affected;
-                    if (fact->total_damage > result->max_damage) result->max_damage = fact->total_damage;
-
-                    // Mínimos
-                    if (fact->total_deaths < result->min_deaths) result->min_deaths = fact->total_deaths;
-                    if (fact->total_affected < result->min_affected) result->min_affected = fact->total_affected;
-                    if (fact->total_damage < result->min_damage) result->min_damage = fact->total_damage;
-                }
-                break;
-            }
-        }
-    }
+    // Duas posições das somas acumuladas, sem percorrer anos nem fatos
+    if (idx->year_sums) return year_sums_aggregate(idx->year_sums, start_year, end_year);
 
-    if (result->count > 0) {
-        result->avg_deaths = (double)result->total_deaths / result->count;
-        result->avg_affected = (double)result->total_affected / result->count;
-        result->avg_damage = (double)result->total_damage / result->count;
-    } else {
-        result->min_deaths = 0;
-        result->min_affected = 0;
-        result->min_damage = 0;
-    }
+    FactFilter filter;
+    fact_filter_init(&filter);
+    filter.start_year = start_year;
+    filter.end_year = end_year;
 
-    return result;
+    return index_aggregate(idx, &filter);
 }
 
 // =============================================================================
@@ -1937,6 +3536,7 @@ int* optimized_query_by_country_and_year_range(OptimizedDataWarehouse *odw, cons
     char cache_key[256];
     snprintf(cache_key, sizeof(cache_key), "country_year_range:%s:%d:%d", country, start_year, end_year);
 
+    optimized_cache_sync(odw);
     int *cached_results = cache_search(odw->cache, cache_key, result_count);
     if (cached_results) {
         return cached_results;
@@ -1966,59 +3566,11 @@ int* optimized_query_with_all_filters(OptimizedDataWarehouse *odw, const char *c
 
     *result_count = 0;
 
-    // Buscar com filtros básicos
-    int *filtered_results = NULL;
+    // O planejador escolhe a ordem dos filtros pelos índices
     int filtered_count = 0;
-
-    // Aplicar filtros em sequência
-    if (country && strlen(country) > 0) {
-        if (start_year > 0 && end_year > 0) {
-            filtered_results = index_search_country_year_range(odw->indexes, country, start_year, end_year, &filtered_count);
-        } else {
-            filtered_results = index_search_by_country(odw->indexes, country, &filtered_count);
-        }
-    } else if (start_year > 0 && end_year > 0) {
-        filtered_results = index_search_by_year_range(odw->indexes, start_year, end_year, &filtered_count);
-    } else {
-        // Sem filtros, retornar todos os fatos
-        filtered_results = malloc(odw->dw->fact_count * sizeof(int));
-        if (filtered_results) {
-            for (int i = 0; i < odw->dw->fact_count; i++) {
-                filtered_results[i] = i;
-            }
-            filtered_count = odw->dw->fact_count;
-        }
-    }
-
+    int *filtered_results = index_search_with_filters(odw->indexes, country, disaster_type,
+                                                      start_year, end_year, &filtered_count);
     if (!filtered_results || filtered_count == 0) {
-        return NULL;
-    }
-
-    // Aplicar filtro de tipo de desastre se especificado
-    if (disaster_type && strlen(disaster_type) > 0) {
-        int *disaster_filtered = malloc(filtered_count * sizeof(int));
-        int disaster_count = 0;
-
-        for (int i = 0; i < filtered_count; i++) {
-            int fact_id = filtered_results[i];
-            DisasterFact *fact = &odw->dw->fact_table[fact_id];
-
-            for (int j = 0; j < odw->dw->disaster_type_count; j++) {
-                if (odw->dw->dim_disaster_type[j].disaster_type_key == fact->disaster_type_key) {
-                    if (strcmp(odw->dw->dim_disaster_type[j].disaster_type, disaster_type) == 0) {
-                        disaster_filtered[disaster_count++] = fact_id;
-                    }
-                    break;
-                }
-            }
-        }
-
-        free(filtered_results);
-        filtered_results = disaster_filtered;
-        filtered_count = disaster_count;
-    }
-
-    if (filtered_count == 0) {
         free(filtered_results);
         return NULL;
     }
@@ -7,6 +7,8 @@
 #include "disaster_star_schema.h"
 #include "bplus.h"
 #include "trie.h"
+#include "roaring_bitmap.h"
+#include "postings.h"
 #include <time.h>
 #include <stdbool.h>
 
@@ -60,34 +62,60 @@ typedef struct {
 // SISTEMA DE CACHE
 // =============================================================================
 
+// Cada entrada guarda a geração dos índices de que foi calculada. Entradas
+// não expiram com o tempo: só deixam de valer quando os dados mudam ou são
+// descartadas por falta de espaço, as menos usadas primeiro.
 typedef struct CacheEntry {
     char query_key[MAX_QUERY_KEY_SIZE];
     int *results;
     int result_count;
-    time_t timestamp;
+    unsigned long long generation;
     int access_count;
-    struct CacheEntry *next;
-    struct CacheEntry *lru_prev;
-    struct CacheEntry *lru_next;
+    unsigned int bucket;             // Posição em entries
+    struct CacheEntry *next;         // Lista do bucket
+    struct CacheEntry *prev;
+    struct CacheEntry *lru_prev;     // Usada mais recentemente
+    struct CacheEntry *lru_next;     // Usada menos recentemente
 } CacheEntry;
 
 typedef struct {
     CacheEntry *entries[CACHE_SIZE];
-    CacheEntry *lru_head;
-    CacheEntry *lru_tail;
+    CacheEntry *lru_head;            // Usada mais recentemente
+    CacheEntry *lru_tail;            // Próxima a ser descartada
     int hit_count;
     int miss_count;
+    int eviction_count;
     int current_size;
-    int max_size;
-    int max_age;
+    int max_size;                    // Máximo de entradas
+    size_t memory_used;              // Bytes das entradas e dos resultados
+    size_t max_memory;               // Orçamento de bytes
+    unsigned long long generation;        // Geração atribuída às entradas novas
+    unsigned long long valid_generation;  // Entradas de gerações anteriores são descartadas
 } CacheSystem;
 
-// Funções do cache
-CacheSystem* cache_system_create(int max_age);
+// Funções do cache. Inserir uma chave existente substitui o resultado; ao
+// passar de max_entries ou max_memory as entradas menos usadas são descartadas.
+CacheSystem* cache_system_create(int max_entries, size_t max_memory);
 void cache_system_destroy(CacheSystem *cache);
 int* cache_search(CacheSystem *cache, const char *query_key, int *result_count);
 int cache_insert(CacheSystem *cache, const char *query_key, int *results, int result_count);
+
+// Passa para a geração informada. Se ela for diferente da atual, todas as
+// entradas deixam de valer imediatamente (O(1); a memória é liberada quando
+// elas são encontradas ou em cache_cleanup_expired).
+void cache_set_generation(CacheSystem *cache, unsigned long long generation);
+
+// Passa para a geração informada mantendo as entradas atuais: o chamador já
+// removeu as que a mudança dos dados afetou (cache_invalidate_matching)
+void cache_advance_generation(CacheSystem *cache, unsigned long long generation);
+
+// Libera as entradas de gerações anteriores
 void cache_cleanup_expired(CacheSystem *cache);
+
+// Remove as entradas para as quais depends(query_key, context) é verdadeiro.
+// Retorna quantas foram removidas.
+int cache_invalidate_matching(CacheSystem *cache, bool (*depends)(const char *query_key, void *context),
+                              void *context);
 void cache_print_statistics(CacheSystem *cache);
 
 // =============================================================================
@@ -100,8 +128,11 @@ typedef struct {
     bool enable_bitmap_indexes;
     bool enable_composite_indexes;
     bool auto_rebuild;
-    int cache_size;
-    int max_cache_age;
+    bool map_bplus_indexes;        // Carregar B+ Trees salvas via mmap (somente leitura)
+    int bplus_order;               // Ordem (fanout) das B+ Trees dos índices
+    double bplus_fill_factor;      // Ocupação dos nós na construção em lote (0 < f <= 1)
+    int cache_size;                // Máximo de consultas no cache
+    size_t cache_memory;           // Máximo de bytes do cache
     char index_directory[256];
 } IndexConfiguration;
 
@@ -115,6 +146,12 @@ void index_config_destroy(IndexConfiguration *config);
 // ESTRUTURA PRINCIPAL DE ÍNDICES
 // =============================================================================
 
+// Cubo de agregações por (ano, geografia, tipo de desastre)
+typedef struct AggregateCube AggregateCube;
+
+// Somas acumuladas por ano (total geral, por país e por tipo de desastre)
+typedef struct YearPrefixSums YearPrefixSums;
+
 typedef struct {
     // === ÍNDICES TRIE PARA STRINGS ===
     Trie *country_trie;           // Busca por país com suporte a prefixo
@@ -136,18 +173,32 @@ typedef struct {
     Trie *year_disaster_trie;     // "2020_Flood" -> fact_ids
 
     // === BITMAP INDEXES ===
-    unsigned char *year_bitmap[200];      // Para anos 1970-2169
-    unsigned char *country_bitmap[250];   // Para até 250 países
-    unsigned char *disaster_bitmap[100];  // Para tipos de desastre
+    // Um bitmap comprimido por valor, criado no primeiro fato com esse valor
+    bool bitmaps_enabled;
+    RoaringBitmap year_bitmap[200];       // Para anos 1970-2169
+    RoaringBitmap *country_bitmap;        // Por geography_key
+    int country_bitmap_count;
+    RoaringBitmap *disaster_bitmap;       // Por disaster_type_key
+    int disaster_bitmap_count;
+
+    // === AGREGAÇÕES MATERIALIZADAS ===
+    AggregateCube *cube;          // Montado após a carga (NULL = agregações varrem os fatos)
+    YearPrefixSums *year_sums;    // Totais de intervalos de anos em O(1) (NULL = usa o cubo)
 
     // === CONFIGURAÇÕES ===
     char index_base_path[256];
     bool indexes_loaded;
+    bool bplus_mapped;            // B+ Trees carregadas do disco são mapeadas
+    double bplus_fill_factor;     // Ocupação dos nós ao reconstruir as B+ Trees
     time_t last_rebuild_time;
 
     // Referência ao data warehouse
     DataWarehouse *dw;
 
+    // Muda a cada construção, carga ou inserção; única entre todos os
+    // sistemas de índices do processo. O cache usa para descartar resultados.
+    unsigned long long generation;
+
 } IndexSystem;
 
 // =============================================================================
@@ -167,7 +218,9 @@ int index_system_build_all(IndexSystem *idx);
 // Reconstruir após inserção
 int index_system_rebuild(IndexSystem *idx);
 
-// Inserir entrada nos índices
+// Inserir nos índices o fato da posição fact_id, já presente no data
+// warehouse, sem reconstruir nada: Tries, B+ Trees, bitmaps, cubo e somas por
+// ano são atualizados no lugar
 int index_system_insert_entry(IndexSystem *idx, int fact_id);
 
 // Persistência
@@ -179,12 +232,6 @@ int index_system_load_all(IndexSystem *idx);
 // =============================================================================
 
 int index_init_bitmaps(IndexSystem *idx);
-void bitmap_set_bit(unsigned char *bitmap, int position);
-void bitmap_clear_bit(unsigned char *bitmap, int position);
-int bitmap_get_bit(unsigned char *bitmap, int position);
-unsigned char* bitmap_and(unsigned char *bitmap1, unsigned char *bitmap2, int size);
-unsigned char* bitmap_or(unsigned char *bitmap1, unsigned char *bitmap2, int size);
-int bitmap_count_bits(unsigned char *bitmap, int size);
 
 // =============================================================================
 // CONSULTAS SIMPLES
@@ -193,15 +240,23 @@ int bitmap_count_bits(unsigned char *bitmap, int size);
 // Busca por país com suporte a prefixo
 int* index_search_by_country(IndexSystem *idx, const char *country, int *result_count);
 
-// Autocompletar país
+// Autocompletar país: até TRIE_TOP_K países, os com mais desastres primeiro
 char** index_search_country_prefix(IndexSystem *idx, const char *prefix, int *result_count);
 
+// Países a no máximo max_distance edições do texto (tolerância a erros de
+// digitação), os mais próximos e com mais desastres primeiro
+char** index_search_country_fuzzy(IndexSystem *idx, const char *country, int max_distance, int *result_count);
+
 // Busca por tipo de desastre
 int* index_search_by_disaster_type(IndexSystem *idx, const char *disaster_type, int *result_count);
 
 // Autocompletar tipo de desastre
 char** index_search_disaster_type_prefix(IndexSystem *idx, const char *prefix, int *result_count);
 
+// Tipos de desastre a no máximo max_distance edições do texto
+char** index_search_disaster_type_fuzzy(IndexSystem *idx, const char *disaster_type, int max_distance,
+                                        int *result_count);
+
 // Busca por ano
 int* index_search_by_year(IndexSystem *idx, int year, int *result_count);
 
@@ -230,6 +285,12 @@ int* index_search_disaster_country(IndexSystem *idx, const char *disaster_type,
 // Consulta tripla
 int* index_search_country_year_disaster(IndexSystem *idx, const char *country, int year, const char *disaster_type, int *result_count);
 
+// Consulta com filtros opcionais (país/tipo NULL ou vazios e anos <= 0 são
+// ignorados). Os filtros são aplicados do mais seletivo para o menos, pela
+// cardinalidade dos bitmaps, intersectando conjuntos antes de ler os fatos.
+int* index_search_with_filters(IndexSystem *idx, const char *country, const char *disaster_type,
+                               int start_year, int end_year, int *result_count);
+
 // =============================================================================
 // FUNÇÕES DE ORDENAÇÃO
 // =============================================================================
@@ -263,6 +324,21 @@ typedef struct {
     long long min_damage;
 } AggregationResult;
 
+// Totais de um intervalo de anos, sem mínimos e máximos
+typedef struct {
+    int count;
+    long long total_deaths;
+    long long total_affected;
+    long long total_damage;
+} YearRangeTotals;
+
+// Totais de [start_year, end_year] pelas somas acumuladas: duas posições e uma
+// subtração. country_code e disaster_type_code são códigos do dicionário
+// (-1 = todos); só um dos dois pode ser informado. Retorna 0 se as somas não
+// estão disponíveis ou a combinação não é coberta.
+int index_year_range_totals(IndexSystem *idx, int country_code, int disaster_type_code,
+                            int start_year, int end_year, YearRangeTotals *totals);
+
 // Agregação por dimensões simples
 AggregationResult* index_aggregate_by_country(IndexSystem *idx, const char *country);
 AggregationResult* index_aggregate_by_year(IndexSystem *idx, int year);
@@ -296,6 +372,15 @@ void optimized_dw_destroy(OptimizedDataWarehouse *odw);
 OptimizedDataWarehouse* optimized_dw_load(const char *base_path);
 int optimized_dw_save(OptimizedDataWarehouse *odw, const char *base_path);
 
+// Inserção incremental: acrescenta o fato ao data warehouse (dw_insert_fact ou
+// dw_convert_from_original), atualiza os índices no lugar e descarta do cache
+// só as consultas que o fato altera. Retornam a posição do fato na tabela ou
+// -1 em erro.
+int optimized_dw_insert_fact(OptimizedDataWarehouse *odw, int time_key, int geography_key,
+                             int disaster_type_key, int total_deaths,
+                             long long total_affected, long long total_damage);
+int optimized_dw_insert_original(OptimizedDataWarehouse *odw, OriginalDisaster *original);
+
 // =============================================================================
 // CONSULTAS OTIMIZADAS
 // =============================================================================
@@ -304,6 +389,11 @@ int optimized_dw_save(OptimizedDataWarehouse *odw, const char *base_path);
 int* optimized_query_by_country(OptimizedDataWarehouse *odw, const char *country, int *result_count);
 char** optimized_autocomplete_country(OptimizedDataWarehouse *odw, const char *prefix, int *result_count);
 
+// Consulta por país tolerante a erros de digitação: usa o país indexado mais
+// próximo do texto e copia seu nome para resolved (se não for NULL)
+int* optimized_query_by_country_fuzzy(OptimizedDataWarehouse *odw, const char *country,
+                                      char *resolved, int resolved_size, int *result_count);
+
 // Consultas por intervalo de anos
 int* optimized_query_by_country_and_year_range(OptimizedDataWarehouse *odw, const char *country,
                                                int start_year, int end_year, int *result_count);
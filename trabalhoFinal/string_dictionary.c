@@ -0,0 +1,146 @@
+#include "string_dictionary.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Estrutura do dicionário: strings indexadas pelo código e tabela hash com
+// endereçamento aberto (cada posição guarda código + 1; 0 indica vazia)
+struct StringDictionary {
+    char **strings;
+    int count;
+    int capacity;
+    int *slots;
+    int slot_count;
+};
+
+// Declarações das funções internas
+static unsigned int string_dict_hash(const char *str);
+static int string_dict_find_slot(const StringDictionary *dict, const char *str);
+static int string_dict_grow(StringDictionary *dict);
+
+static unsigned int string_dict_hash(const char *str) {
+    unsigned int hash = 5381;
+    int c;
+    while ((c = (unsigned char)*str++))
+        hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+// Retorna a posição onde a string está ou onde deveria ser inserida
+static int string_dict_find_slot(const StringDictionary *dict, const char *str) {
+    unsigned int mask = dict->slot_count - 1;
+    unsigned int slot = string_dict_hash(str) & mask;
+
+    while (dict->slots[slot]) {
+        if (strcmp(dict->strings[dict->slots[slot] - 1], str) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Dobra a capacidade e redistribui os códigos na nova tabela hash. Se alguma
+// alocação falhar o dicionário fica inalterado (capacidade e tabela hash
+// continuam consistentes entre si).
+static int string_dict_grow(StringDictionary *dict) {
+    int new_capacity = dict->capacity * 2;
+    int *new_slots = calloc(new_capacity * 2, sizeof(int));
+    if (!new_slots) return 0;
+
+    char **new_strings = realloc(dict->strings, new_capacity * sizeof(char*));
+    if (!new_strings) {
+        free(new_slots);
+        return 0;
+    }
+    dict->strings = new_strings;
+    dict->capacity = new_capacity;
+
+    free(dict->slots);
+    dict->slots = new_slots;
+    dict->slot_count = new_capacity * 2;
+
+    for (int code = 0; code < dict->count; code++) {
+        int slot = string_dict_find_slot(dict, dict->strings[code]);
+        dict->slots[slot] = code + 1;
+    }
+    return 1;
+}
+
+StringDictionary* string_dict_create(int initial_capacity) {
+    StringDictionary *dict = malloc(sizeof(StringDictionary));
+    if (!dict) return NULL;
+
+    // Capacidade em potência de 2 para a máscara da tabela hash
+    int capacity = 16;
+    while (capacity < initial_capacity) {
+        capacity <<= 1;
+    }
+
+    dict->strings = malloc(capacity * sizeof(char*));
+    dict->slots = calloc(capacity * 2, sizeof(int));
+    dict->count = 0;
+    dict->capacity = capacity;
+    dict->slot_count = capacity * 2;
+
+    if (!dict->strings || !dict->slots) {
+        free(dict->strings);
+        free(dict->slots);
+        free(dict);
+        return NULL;
+    }
+
+    return dict;
+}
+
+void string_dict_destroy(StringDictionary *dict) {
+    if (!dict) return;
+
+    for (int i = 0; i < dict->count; i++) {
+        free(dict->strings[i]);
+    }
+    free(dict->strings);
+    free(dict->slots);
+    free(dict);
+}
+
+int string_dict_intern(StringDictionary *dict, const char *str) {
+    if (!dict || !str) return -1;
+
+    int slot = string_dict_find_slot(dict, str);
+    if (dict->slots[slot]) {
+        return dict->slots[slot] - 1;
+    }
+
+    // Mantém fator de carga <= 0.5
+    if (dict->count >= dict->capacity) {
+        if (!string_dict_grow(dict)) return -1;
+        slot = string_dict_find_slot(dict, str);
+    }
+
+    char *copy = malloc(strlen(str) + 1);
+    if (!copy) return -1;
+    strcpy(copy, str);
+
+    int code = dict->count++;
+    dict->strings[code] = copy;
+    dict->slots[slot] = code + 1;
+
+    return code;
+}
+
+int string_dict_lookup(const StringDictionary *dict, const char *str) {
+    if (!dict || !str) return -1;
+
+    int slot = string_dict_find_slot(dict, str);
+    return dict->slots[slot] ? dict->slots[slot] - 1 : -1;
+}
+
+const char* string_dict_get(const StringDictionary *dict, int code) {
+    if (!dict || code < 0 || code >= dict->count) return "";
+    return dict->strings[code];
+}
+
+int string_dict_count(const StringDictionary *dict) {
+    return dict ? dict->count : 0;
+}
@@ -0,0 +1,26 @@
+// =============================================================================
+// string_dictionary.h - Dicionário global de strings (codificação por inteiros)
+// =============================================================================
+#ifndef STRING_DICTIONARY_H
+#define STRING_DICTIONARY_H
+
+// Cada string distinta recebe um código inteiro pequeno e denso (0, 1, 2, ...)
+// na ordem em que é inserida. Os filtros resolvem a string do usuário para um
+// código uma única vez e depois comparam apenas inteiros.
+typedef struct StringDictionary StringDictionary;
+
+StringDictionary* string_dict_create(int initial_capacity);
+void string_dict_destroy(StringDictionary *dict);
+
+// Retorna o código da string, inserindo-a se ainda não existir (-1 em erro)
+int string_dict_intern(StringDictionary *dict, const char *str);
+
+// Retorna o código da string ou -1 se ela não está no dicionário
+int string_dict_lookup(const StringDictionary *dict, const char *str);
+
+// Retorna a string de um código ("" para códigos inválidos)
+const char* string_dict_get(const StringDictionary *dict, int code);
+
+int string_dict_count(const StringDictionary *dict);
+
+#endif
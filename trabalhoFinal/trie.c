@@ -3,17 +3,39 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 #define ALPHABET_SIZE 128
-#define MAX_VALUES 1000
-
-// Nó da Trie
+#define TRIE_INITIAL_VALUES 4
+#define TRIE_MAX_WORD 256
+
+// Formato do arquivo: cabeçalho seguido dos nós em pré-ordem
+#define TRIE_FILE_MAGIC 0x32495254  // "TRI2"
+#define TRIE_FILE_VERSION 2
+
+// Nó da Trie com compressão de caminho: cada nó guarda o rótulo da aresta
+// que chega até ele, então sequências de nós com um único filho viram uma
+// única aresta ("2020_brazil" ocupa um nó, não onze). Os filhos ficam em um
+// vetor pequeno ordenado pelo primeiro caractere da aresta: um único bloco com
+// child_capacity ponteiros seguidos desses caracteres. A lista de valores só
+// é alocada quando o nó termina uma palavra e guarda os ids como int.
+// top guarda as até TRIE_TOP_K palavras da subárvore com mais valores; é
+// calculado na primeira busca ranqueada e descartado quando uma inserção
+// passa pelo nó.
 typedef struct TrieNode {
-    struct TrieNode *children[ALPHABET_SIZE];
-    long *values;
+    char *edge;                 // Rótulo da aresta (sem '\0'); vazio na raiz
+    int edge_length;
+    struct TrieNode *parent;
+    struct TrieNode **children;
+    unsigned char *labels;      // Primeiro caractere da aresta de cada filho
+    int child_count;
+    int child_capacity;
+    int *values;
     int value_count;
     int value_capacity;
     int is_end_of_word;
+    struct TrieNode **top;      // Nós finais ranqueados (NULL = não calculado)
+    int top_count;
 } TrieNode;
 
 // Estrutura da Trie
@@ -25,35 +47,170 @@ struct Trie {
 // Declarações das funções internas
 TrieNode* trie_create_node(void);
 void trie_destroy_node(TrieNode *node);
-char* normalize_string(const char *str);
+int normalize_string(const char *str, char *buffer);
 int char_to_index(char c);
-int trie_search_prefix_internal(TrieNode *node, const char *prefix, int pos,
-                               char **results, int *result_count, int max_results,
-                               char *current_word, int word_pos);
 int trie_save_node(FILE *file, TrieNode *node);
 TrieNode* trie_load_node(FILE *file);
+static TrieNode* trie_create_edge_node(const char *edge, int edge_length);
+static TrieNode* trie_find_child(const TrieNode *node, int index);
+static int trie_attach_child(TrieNode *node, int index, TrieNode *child);
+static int trie_add_value(TrieNode *node, int value);
+static void trie_invalidate_top(TrieNode *node);
 
 TrieNode* trie_create_node(void) {
     TrieNode *node = malloc(sizeof(TrieNode));
     if (!node) return NULL;
 
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
-        node->children[i] = NULL;
-    }
+    node->edge = NULL;
+    node->edge_length = 0;
+    node->parent = NULL;
+    node->children = NULL;
+    node->labels = NULL;
+    node->child_count = 0;
+    node->child_capacity = 0;
+    node->values = NULL;
+    node->value_count = 0;
+    node->value_capacity = 0;
+    node->is_end_of_word = 0;
+    node->top = NULL;
+    node->top_count = 0;
+
+    return node;
+}
 
-    node->values = malloc(MAX_VALUES * sizeof(long));
-    if (!node->values) {
+// Cria um nó cuja aresta de entrada é uma cópia de edge[0..edge_length)
+static TrieNode* trie_create_edge_node(const char *edge, int edge_length) {
+    TrieNode *node = trie_create_node();
+    if (!node) return NULL;
+
+    node->edge = malloc(edge_length > 0 ? edge_length : 1);
+    if (!node->edge) {
         free(node);
         return NULL;
     }
-
-    node->value_count = 0;
-    node->value_capacity = MAX_VALUES;
-    node->is_end_of_word = 0;
+    memcpy(node->edge, edge, edge_length);
+    node->edge_length = edge_length;
 
     return node;
 }
 
+// Posição do caractere no vetor de filhos (ou onde deveria ser inserido)
+static int trie_child_position(const TrieNode *node, int index) {
+    int low = 0, high = node->child_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (node->labels[mid] < index) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Filho cuja aresta começa pelo caractere
+static TrieNode* trie_find_child(const TrieNode *node, int index) {
+    int pos = trie_child_position(node, index);
+    if (pos < node->child_count && node->labels[pos] == index) {
+        return node->children[pos];
+    }
+    return NULL;
+}
+
+// Liga um filho ao caractere mantendo o vetor ordenado
+static int trie_attach_child(TrieNode *node, int index, TrieNode *child) {
+    int pos = trie_child_position(node, index);
+
+    if (node->child_count == node->child_capacity) {
+        int new_capacity = node->child_capacity > 0 ? node->child_capacity * 2 : 1;
+        if (new_capacity > ALPHABET_SIZE) new_capacity = ALPHABET_SIZE;
+
+        TrieNode **block = malloc(new_capacity * (sizeof(TrieNode*) + 1));
+        if (!block) return 0;
+        unsigned char *labels = (unsigned char *)(block + new_capacity);
+
+        if (node->child_count > 0) {
+            memcpy(block, node->children, node->child_count * sizeof(TrieNode*));
+            memcpy(labels, node->labels, node->child_count);
+        }
+        free(node->children);
+        node->children = block;
+        node->labels = labels;
+        node->child_capacity = new_capacity;
+    }
+
+    memmove(&node->children[pos + 1], &node->children[pos], (node->child_count - pos) * sizeof(TrieNode*));
+    memmove(&node->labels[pos + 1], &node->labels[pos], node->child_count - pos);
+    node->children[pos] = child;
+    node->labels[pos] = (unsigned char)index;
+    node->child_count++;
+    child->parent = node;
+
+    return 1;
+}
+
+// Divide a aresta do filho após split caracteres: um nó intermediário passa a
+// ter a parte inicial e o filho fica com o restante. Retorna o intermediário.
+static TrieNode* trie_split_edge(TrieNode *parent, TrieNode *child, int split) {
+    TrieNode *middle = trie_create_edge_node(child->edge, split);
+    if (!middle) return NULL;
+
+    if (!trie_attach_child(middle, (unsigned char)child->edge[split], child)) {
+        trie_destroy_node(middle);
+        return NULL;
+    }
+
+    // A partir daqui nada aloca memória: a árvore não fica pela metade
+    memmove(child->edge, child->edge + split, child->edge_length - split);
+    child->edge_length -= split;
+    parent->children[trie_child_position(parent, (unsigned char)middle->edge[0])] = middle;
+    middle->parent = parent;
+
+    return middle;
+}
+
+// Adiciona um valor ao nó ignorando repetições. A lista fica em ordem
+// crescente, o que permite intersectar listas de Tries diferentes por merge.
+// Os valores costumam chegar em ordem, então o caso comum é acrescentar no fim.
+static int trie_add_value(TrieNode *node, int value) {
+    int pos = node->value_count;
+    if (pos > 0 && value <= node->values[pos - 1]) {
+        int low = 0, high = node->value_count;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (node->values[mid] < value) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (node->values[low] == value) return 1; // Valor já existe, mas não é erro
+        pos = low;
+    }
+
+    if (node->value_count == node->value_capacity) {
+        int new_capacity = node->value_capacity > 0 ? node->value_capacity * 2 : TRIE_INITIAL_VALUES;
+        int *new_values = realloc(node->values, new_capacity * sizeof(int));
+        if (!new_values) return 0;
+        node->values = new_values;
+        node->value_capacity = new_capacity;
+    }
+
+    memmove(&node->values[pos + 1], &node->values[pos], (node->value_count - pos) * sizeof(int));
+    node->values[pos] = value;
+    node->value_count++;
+    return 1;
+}
+
+// Descarta o ranking do nó e dos ancestrais, que podem ter mudado
+static void trie_invalidate_top(TrieNode *node) {
+    for (; node; node = node->parent) {
+        free(node->top);
+        node->top = NULL;
+        node->top_count = 0;
+    }
+}
+
 // Função para mapear caracteres
 int char_to_index(char c) {
     // Mapear caracteres ASCII para índices
@@ -63,24 +220,43 @@ int char_to_index(char c) {
     return -1; // Caractere inválido
 }
 
-// Normaliza strings para busca case-insensitive
-char* normalize_string(const char *str) {
-    if (!str) return NULL;
+// Normaliza strings para busca case-insensitive, escrevendo no buffer do
+// chamador (TRIE_MAX_WORD bytes) para que as buscas não aloquem memória.
+// Retorna o tamanho ou -1 se a palavra não couber.
+int normalize_string(const char *str, char *buffer) {
+    if (!str) return -1;
 
-    int len = strlen(str);
-    char *normalized = malloc(len + 1);
-    if (!normalized) return NULL;
+    int len = 0;
+    for (; str[len]; len++) {
+        if (len >= TRIE_MAX_WORD - 1) return -1;
 
-    for (int i = 0; i < len; i++) {
-        normalized[i] = tolower(str[i]);
+        buffer[len] = tolower((unsigned char)str[len]);
         // Substitui espaços por underscores para compatibilidade
-        if (normalized[i] == ' ') {
-            normalized[i] = '_';
+        if (buffer[len] == ' ') {
+            buffer[len] = '_';
         }
     }
-    normalized[len] = '\0';
+    buffer[len] = '\0';
 
-    return normalized;
+    return len;
+}
+
+// Verifica se todos os caracteres podem ser indexados
+static int trie_valid_word(const char *word, int len) {
+    for (int i = 0; i < len; i++) {
+        if (char_to_index(word[i]) == -1) return 0;
+    }
+    return 1;
+}
+
+// Tamanho do prefixo comum entre a aresta e o texto
+static int trie_common_prefix(const TrieNode *node, const char *text, int text_length) {
+    int max = node->edge_length < text_length ? node->edge_length : text_length;
+    int i = 0;
+    while (i < max && node->edge[i] == text[i]) {
+        i++;
+    }
+    return i;
 }
 
 Trie* trie_create(const char *filename) {
@@ -102,11 +278,14 @@ Trie* trie_create(const char *filename) {
 void trie_destroy_node(TrieNode *node) {
     if (!node) return;
 
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
+    for (int i = 0; i < node->child_count; i++) {
         trie_destroy_node(node->children[i]);
     }
 
+    free(node->edge);
+    free(node->children);
     free(node->values);
+    free(node->top);
     free(node);
 }
 
@@ -118,144 +297,153 @@ void trie_destroy(Trie *trie) {
 }
 
 int trie_insert(Trie *trie, const char *word, long value) {
-    if (!trie || !word) return 0;
+    if (!trie || !word || value < INT_MIN || value > INT_MAX) return 0;
 
-    // Normaliza string antes de inserir
-    char *normalized_word = normalize_string(word);
-    if (!normalized_word) return 0;
+    // Normaliza string antes de inserir; palavras maiores que o buffer não são indexadas
+    char normalized_word[TRIE_MAX_WORD];
+    int len = normalize_string(word, normalized_word);
+    if (len < 0 || !trie_valid_word(normalized_word, len)) {
+        return 0; // Caractere inválido
+    }
 
     TrieNode *current = trie->root;
-    int len = strlen(normalized_word);
+    int pos = 0;
 
-    for (int i = 0; i < len; i++) {
-        int index = char_to_index(normalized_word[i]);
-        if (index == -1) {
-            free(normalized_word);
-            return 0; // Caractere inválido
-        }
+    while (pos < len) {
+        int index = (unsigned char)normalized_word[pos];
+        TrieNode *child = trie_find_child(current, index);
 
-        if (!current->children[index]) {
-            current->children[index] = trie_create_node();
-            if (!current->children[index]) {
-                free(normalized_word);
+        // Nenhuma aresta começa pelo caractere: o resto da palavra vira uma aresta
+        if (!child) {
+            child = trie_create_edge_node(normalized_word + pos, len - pos);
+            if (!child || !trie_attach_child(current, index, child)) {
+                trie_destroy_node(child);
                 return 0;
             }
+            current = child;
+            break;
         }
 
-        current = current->children[index];
+        // A palavra diverge (ou termina) no meio da aresta: dividi-la
+        int common = trie_common_prefix(child, normalized_word + pos, len - pos);
+        if (common < child->edge_length) {
+            child = trie_split_edge(current, child, common);
+            if (!child) return 0;
+        }
+
+        current = child;
+        pos += common;
     }
 
     current->is_end_of_word = 1;
 
-    // Verifica duplicatas antes de adicionar
-    for (int i = 0; i < current->value_count; i++) {
-        if (current->values[i] == value) {
-            free(normalized_word);
-            return 1; // Valor já existe, mas não é erro
-        }
-    }
+    int added = trie_add_value(current, (int)value);
+    trie_invalidate_top(current);
+    return added;
+}
+
+// Desce pela palavra já normalizada; retorna o nó onde ela termina exatamente
+static TrieNode* trie_find_node(TrieNode *root, const char *word, int len) {
+    TrieNode *current = root;
+    int pos = 0;
 
-    // Adiciona o valor se houver espaço
-    if (current->value_count < current->value_capacity) {
-        current->values[current->value_count] = value;
-        current->value_count++;
-    } else {
-        long *new_values = realloc(current->values,
-                                  (current->value_capacity * 2) * sizeof(long));
-        if (new_values) {
-            current->values = new_values;
-            current->values[current->value_count] = value;
-            current->value_count++;
-            current->value_capacity *= 2;
+    while (pos < len) {
+        current = trie_find_child(current, (unsigned char)word[pos]);
+        if (!current || current->edge_length > len - pos ||
+            memcmp(current->edge, word + pos, current->edge_length) != 0) {
+            return NULL; // Palavra não encontrada
         }
+        pos += current->edge_length;
     }
 
-    free(normalized_word);
-    return 1;
+    return current;
 }
 
-long* trie_search(Trie *trie, const char *word, int *count) {
+const int* trie_search_view(const Trie *trie, const char *word, int *count) {
     *count = 0;
     if (!trie || !word) return NULL;
 
     // Normaliza string antes de buscar
-    char *normalized_word = normalize_string(word);
-    if (!normalized_word) return NULL;
+    char normalized_word[TRIE_MAX_WORD];
+    int len = normalize_string(word, normalized_word);
+    if (len < 0) return NULL;
 
-    TrieNode *current = trie->root;
-    int len = strlen(normalized_word);
+    const TrieNode *current = trie_find_node(trie->root, normalized_word, len);
+    if (current && current->is_end_of_word && current->value_count > 0) {
+        *count = current->value_count;
+        return current->values;
+    }
 
-    for (int i = 0; i < len; i++) {
-        int index = char_to_index(normalized_word[i]);
-        if (index == -1) {
-            free(normalized_word);
-            return NULL;
-        }
+    return NULL;
+}
 
-        if (!current->children[index]) {
-            free(normalized_word);
-            return NULL; // Palavra não encontrada
-        }
+long* trie_search(Trie *trie, const char *word, int *count) {
+    const int *values = trie_search_view(trie, word, count);
+    if (!values) return NULL;
 
-        current = current->children[index];
+    long *result = malloc(*count * sizeof(long));
+    if (!result) {
+        *count = 0;
+        return NULL;
     }
 
-    free(normalized_word);
+    for (int i = 0; i < *count; i++) {
+        result[i] = values[i];
+    }
 
-    if (current->is_end_of_word && current->value_count > 0) {
-        long *result = malloc(current->value_count * sizeof(long));
-        if (!result) return NULL;
+    return result;
+}
 
-        for (int i = 0; i < current->value_count; i++) {
-            result[i] = current->values[i];
+// Coleta as palavras da subárvore em ordem alfabética. current_word contém o
+// caminho até o nó (word_pos caracteres, incluindo a aresta do próprio nó).
+static void trie_collect_words(const TrieNode *node, char **results, int *result_count, int max_results,
+                               char *current_word, int word_pos) {
+    if (node->is_end_of_word && *result_count < max_results) {
+        current_word[word_pos] = '\0';
+        results[*result_count] = malloc(word_pos + 1);
+        if (results[*result_count]) {
+            strcpy(results[*result_count], current_word);
+            (*result_count)++;
         }
-
-        *count = current->value_count;
-        return result;
     }
 
-    return NULL;
+    // Continuar explorando filhos (já em ordem alfabética)
+    for (int i = 0; i < node->child_count && *result_count < max_results; i++) {
+        const TrieNode *child = node->children[i];
+        if (word_pos + child->edge_length >= TRIE_MAX_WORD) continue;
+
+        memcpy(current_word + word_pos, child->edge, child->edge_length);
+        trie_collect_words(child, results, result_count, max_results,
+                           current_word, word_pos + child->edge_length);
+    }
 }
 
-// Função para busca por prefixo
-int trie_search_prefix_internal(TrieNode *node, const char *prefix, int pos,
-                               char **results, int *result_count, int max_results,
-                               char *current_word, int word_pos) {
-    if (!node || *result_count >= max_results) return 0;
-
-    if (pos == strlen(prefix)) {
-        // Chegou ao final do prefixo, coletar todas as palavras a partir daqui
-        if (node->is_end_of_word) {
-            current_word[word_pos] = '\0';
-            results[*result_count] = malloc(strlen(current_word) + 1);
-            if (results[*result_count]) {
-                strcpy(results[*result_count], current_word);
-                (*result_count)++;
-            }
-        }
+// Navega pelo prefixo, que pode terminar no meio de uma aresta, e retorna o
+// primeiro nó cuja subárvore contém todas as palavras com ele. current_word
+// recebe o caminho até esse nó (*word_length caracteres, sem '\0').
+static TrieNode* trie_find_prefix_node(const Trie *trie, const char *prefix, char *current_word, int *word_length) {
+    char normalized_prefix[TRIE_MAX_WORD];
+    int len = normalize_string(prefix, normalized_prefix);
+    if (len < 0) return NULL;
 
-        // Continuar explorando filhos
-        for (int i = 0; i < ALPHABET_SIZE && *result_count < max_results; i++) {
-            if (node->children[i]) {
-                current_word[word_pos] = (char)i;
-                trie_search_prefix_internal(node->children[i], prefix, pos,
-                                          results, result_count, max_results,
-                                          current_word, word_pos + 1);
-            }
+    TrieNode *current = trie->root;
+    int pos = 0;
+
+    while (pos < len) {
+        current = trie_find_child(current, (unsigned char)normalized_prefix[pos]);
+        int remaining = len - pos;
+        int compare = current && current->edge_length < remaining ? current->edge_length : remaining;
+        if (!current || memcmp(current->edge, normalized_prefix + pos, compare) != 0 ||
+            pos + current->edge_length >= TRIE_MAX_WORD) {
+            return NULL;
         }
-        return 1;
-    }
 
-    // Ainda navegando pelo prefixo
-    int index = char_to_index(prefix[pos]);
-    if (index != -1 && node->children[index]) {
-        current_word[word_pos] = prefix[pos];
-        return trie_search_prefix_internal(node->children[index], prefix, pos + 1,
-                                         results, result_count, max_results,
-                                         current_word, word_pos + 1);
+        memcpy(current_word + pos, current->edge, current->edge_length);
+        pos += current->edge_length;
     }
 
-    return 0;
+    *word_length = pos;
+    return current;
 }
 
 // Nova função para busca por prefixo
@@ -263,21 +451,114 @@ char** trie_search_prefix(Trie *trie, const char *prefix, int *result_count, int
     *result_count = 0;
     if (!trie || !prefix || max_results <= 0) return NULL;
 
-    char *normalized_prefix = normalize_string(prefix);
-    if (!normalized_prefix) return NULL;
+    char current_word[TRIE_MAX_WORD];
+    int pos;
+    TrieNode *current = trie_find_prefix_node(trie, prefix, current_word, &pos);
+    if (!current) return NULL;
 
     char **results = malloc(max_results * sizeof(char*));
-    if (!results) {
-        free(normalized_prefix);
+    if (!results) return NULL;
+
+    trie_collect_words(current, results, result_count, max_results, current_word, pos);
+
+    if (*result_count == 0) {
+        free(results);
         return NULL;
     }
 
-    char current_word[256];
-    trie_search_prefix_internal(trie->root, normalized_prefix, 0,
-                              results, result_count, max_results,
-                              current_word, 0);
+    return results;
+}
+
+// =============================================================================
+// BUSCA RANQUEADA
+// =============================================================================
+//
+// Cada nó guarda os TRIE_TOP_K nós finais da sua subárvore com mais valores,
+// em ordem decrescente (empates em ordem alfabética). O ranking de um nó é a
+// junção do próprio nó com os rankings dos filhos, então depois de calculado
+// uma busca custa o tamanho do prefixo mais K, sem percorrer a subárvore.
+
+// Insere o nó no ranking se couber. Retorna 0 se ficou de fora; como os
+// rankings dos filhos são decrescentes, os seguintes também ficariam.
+static int trie_rank_insert(TrieNode **best, int *count, TrieNode *node) {
+    if (*count == TRIE_TOP_K && node->value_count <= best[TRIE_TOP_K - 1]->value_count) {
+        return 0;
+    }
+
+    int pos = *count < TRIE_TOP_K ? *count : TRIE_TOP_K - 1;
+    while (pos > 0 && best[pos - 1]->value_count < node->value_count) {
+        best[pos] = best[pos - 1];
+        pos--;
+    }
+    best[pos] = node;
+    if (*count < TRIE_TOP_K) (*count)++;
+
+    return 1;
+}
+
+static int trie_build_top(TrieNode *node) {
+    if (node->top) return 1;
+
+    TrieNode *best[TRIE_TOP_K];
+    int count = 0;
+
+    if (node->is_end_of_word && node->value_count > 0) {
+        best[count++] = node;
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        TrieNode *child = node->children[i];
+        if (!trie_build_top(child)) return 0;
+
+        for (int j = 0; j < child->top_count; j++) {
+            if (!trie_rank_insert(best, &count, child->top[j])) break;
+        }
+    }
+
+    node->top = malloc((count > 0 ? count : 1) * sizeof(TrieNode*));
+    if (!node->top) return 0;
+    memcpy(node->top, best, count * sizeof(TrieNode*));
+    node->top_count = count;
+
+    return 1;
+}
+
+// Reconstrói a palavra subindo pelos pais
+static char* trie_node_word(const TrieNode *node) {
+    int length = 0;
+    for (const TrieNode *n = node; n; n = n->parent) {
+        length += n->edge_length;
+    }
+
+    char *word = malloc(length + 1);
+    if (!word) return NULL;
+
+    word[length] = '\0';
+    for (const TrieNode *n = node; n; n = n->parent) {
+        length -= n->edge_length;
+        if (n->edge_length > 0) memcpy(word + length, n->edge, n->edge_length);
+    }
+
+    return word;
+}
+
+char** trie_search_prefix_ranked(Trie *trie, const char *prefix, int *result_count, int max_results) {
+    *result_count = 0;
+    if (!trie || !prefix || max_results <= 0) return NULL;
+
+    char current_word[TRIE_MAX_WORD];
+    int pos;
+    TrieNode *current = trie_find_prefix_node(trie, prefix, current_word, &pos);
+    if (!current || !trie_build_top(current) || current->top_count == 0) return NULL;
 
-    free(normalized_prefix);
+    if (max_results > current->top_count) max_results = current->top_count;
+
+    char **results = malloc(max_results * sizeof(char*));
+    if (!results) return NULL;
+
+    for (int i = 0; i < max_results; i++) {
+        results[*result_count] = trie_node_word(current->top[i]);
+        if (results[*result_count]) (*result_count)++;
+    }
 
     if (*result_count == 0) {
         free(results);
@@ -287,43 +568,220 @@ char** trie_search_prefix(Trie *trie, const char *prefix, int *result_count, int
     return results;
 }
 
-// Melhorar salvamento para suportar ALPHABET_SIZE maior
-int trie_save_node(FILE *file, TrieNode *node) {
-    if (!node) {
-        int null_marker = 0;
-        if (fwrite(&null_marker, sizeof(int), 1, file) != 1) return 0;
-        return 1;
+// =============================================================================
+// BUSCA APROXIMADA
+// =============================================================================
+//
+// Busca pela distância de Levenshtein: a descida calcula uma linha da matriz
+// de edição por caractere da aresta, reaproveitando a linha do pai. Quando o
+// menor valor da linha passa de max_distance nenhuma palavra da subárvore pode
+// servir e o ramo é cortado, então só uma fração pequena da Trie é visitada.
+
+typedef struct {
+    const char *target;
+    int target_length;
+    int max_distance;
+    int row_count;              // Linhas disponíveis em rows
+    int *rows;                  // Linha d = distâncias do prefixo de tamanho d
+    char word[TRIE_MAX_WORD];
+    TrieFuzzyMatch *matches;
+    int match_count;
+    int match_capacity;
+    int failed;
+} TrieFuzzySearch;
+
+static void trie_fuzzy_add_match(TrieFuzzySearch *search, const TrieNode *node, int length, int distance) {
+    if (search->match_count == search->match_capacity) {
+        int new_capacity = search->match_capacity > 0 ? search->match_capacity * 2 : 16;
+        TrieFuzzyMatch *new_matches = realloc(search->matches, new_capacity * sizeof(TrieFuzzyMatch));
+        if (!new_matches) {
+            search->failed = 1;
+            return;
+        }
+        search->matches = new_matches;
+        search->match_capacity = new_capacity;
     }
 
-    int node_marker = 1;
-    if (fwrite(&node_marker, sizeof(int), 1, file) != 1) return 0;
-    if (fwrite(&node->is_end_of_word, sizeof(int), 1, file) != 1) return 0;
-    if (fwrite(&node->value_count, sizeof(int), 1, file) != 1) return 0;
+    char *word = malloc(length + 1);
+    if (!word) {
+        search->failed = 1;
+        return;
+    }
+    memcpy(word, search->word, length);
+    word[length] = '\0';
 
-    if (node->value_count > 0) {
-        if (fwrite(node->values, sizeof(long), node->value_count, file) != node->value_count) {
-            return 0;
+    TrieFuzzyMatch *match = &search->matches[search->match_count++];
+    match->word = word;
+    match->distance = distance;
+    match->value_count = node->value_count;
+}
+
+// depth é o tamanho do caminho até o nó; a linha depth já está calculada
+static void trie_fuzzy_visit(TrieFuzzySearch *search, const TrieNode *node, int depth) {
+    int width = search->target_length + 1;
+    const int *row = search->rows + depth * width;
+
+    if (node->is_end_of_word && node->value_count > 0 &&
+        row[search->target_length] <= search->max_distance) {
+        trie_fuzzy_add_match(search, node, depth, row[search->target_length]);
+    }
+
+    for (int i = 0; i < node->child_count && !search->failed; i++) {
+        const TrieNode *child = node->children[i];
+        int d = depth;
+        int alive = 1;
+
+        for (int k = 0; k < child->edge_length && alive; k++) {
+            if (d + 1 >= search->row_count || d + 1 >= TRIE_MAX_WORD) {
+                alive = 0;
+                break;
+            }
+
+            char c = child->edge[k];
+            const int *previous = search->rows + d * width;
+            int *current = search->rows + (d + 1) * width;
+
+            current[0] = previous[0] + 1;
+            int best = current[0];
+            for (int j = 1; j < width; j++) {
+                int cost = search->target[j - 1] == c ? 0 : 1;
+                int value = previous[j - 1] + cost;
+                if (previous[j] + 1 < value) value = previous[j] + 1;
+                if (current[j - 1] + 1 < value) value = current[j - 1] + 1;
+                current[j] = value;
+                if (value < best) best = value;
+            }
+
+            search->word[d++] = c;
+            if (best > search->max_distance) alive = 0;
+        }
+
+        if (alive) {
+            trie_fuzzy_visit(search, child, d);
         }
     }
+}
 
-    // Salva informação sobre quais filhos existem
-    unsigned char children_bitmap[ALPHABET_SIZE / 8 + 1];
-    memset(children_bitmap, 0, sizeof(children_bitmap));
+// Menor distância primeiro; depois as palavras com mais valores
+static int trie_compare_fuzzy_matches(const void *a, const void *b) {
+    const TrieFuzzyMatch *x = a, *y = b;
+    if (x->distance != y->distance) return x->distance - y->distance;
+    if (x->value_count != y->value_count) return y->value_count - x->value_count;
+    return strcmp(x->word, y->word);
+}
 
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
-        if (node->children[i]) {
-            children_bitmap[i / 8] |= (1 << (i % 8));
+TrieFuzzyMatch* trie_search_fuzzy(Trie *trie, const char *word, int max_distance,
+                                  int *result_count, int max_results) {
+    *result_count = 0;
+    if (!trie || !word || max_distance < 0 || max_results <= 0) return NULL;
+
+    char normalized_word[TRIE_MAX_WORD];
+    int len = normalize_string(word, normalized_word);
+    if (len < 0) return NULL;
+
+    // Palavras com mais de len + max_distance caracteres estão sempre longe demais
+    TrieFuzzySearch search;
+    memset(&search, 0, sizeof(search));
+    search.target = normalized_word;
+    search.target_length = len;
+    search.max_distance = max_distance;
+    search.row_count = len + max_distance + 1;
+    search.rows = malloc((size_t)search.row_count * (len + 1) * sizeof(int));
+    if (!search.rows) return NULL;
+
+    for (int j = 0; j <= len; j++) {
+        search.rows[j] = j;
+    }
+    trie_fuzzy_visit(&search, trie->root, 0);
+    free(search.rows);
+
+    if (search.failed || search.match_count == 0) {
+        trie_free_fuzzy_matches(search.matches, search.match_count);
+        return NULL;
+    }
+
+    qsort(search.matches, search.match_count, sizeof(TrieFuzzyMatch), trie_compare_fuzzy_matches);
+
+    // Mantém apenas os max_results melhores
+    for (int i = max_results; i < search.match_count; i++) {
+        free(search.matches[i].word);
+    }
+    *result_count = search.match_count < max_results ? search.match_count : max_results;
+
+    return search.matches;
+}
+
+void trie_free_fuzzy_matches(TrieFuzzyMatch *matches, int count) {
+    if (!matches) return;
+
+    for (int i = 0; i < count; i++) {
+        free(matches[i].word);
+    }
+    free(matches);
+}
+
+// =============================================================================
+// PERSISTÊNCIA
+// =============================================================================
+//
+// Cada nó é gravado como: tamanho da aresta, bytes da aresta, marcador de fim
+// de palavra, quantidade de valores, valores e quantidade de filhos, seguido
+// dos filhos em ordem. Números são varints; o primeiro valor é gravado em
+// zigzag e os demais como diferença (zigzag) para o anterior.
+
+static int trie_write_varint(FILE *file, unsigned long long value) {
+    unsigned char buffer[10];
+    int size = 0;
+    while (value >= 0x80) {
+        buffer[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = (unsigned char)value;
+    return fwrite(buffer, 1, size, file) == (size_t)size;
+}
+
+static int trie_read_varint(FILE *file, unsigned long long *value) {
+    unsigned long long result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) return 0;
+        result |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
         }
     }
+    return 0;
+}
 
-    if (fwrite(children_bitmap, sizeof(children_bitmap), 1, file) != 1) return 0;
+static unsigned long long trie_zigzag_encode(long long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value < 0 ? -1LL : 0);
+}
 
-    // Salva apenas os filhos que existem
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
-        if (node->children[i]) {
-            if (!trie_save_node(file, node->children[i])) {
-                return 0;
-            }
+static long long trie_zigzag_decode(unsigned long long value) {
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+int trie_save_node(FILE *file, TrieNode *node) {
+    if (!trie_write_varint(file, node->edge_length)) return 0;
+    if (node->edge_length > 0 &&
+        fwrite(node->edge, 1, node->edge_length, file) != (size_t)node->edge_length) {
+        return 0;
+    }
+    if (fputc(node->is_end_of_word ? 1 : 0, file) == EOF) return 0;
+
+    if (!trie_write_varint(file, node->value_count)) return 0;
+    long long previous = 0;
+    for (int i = 0; i < node->value_count; i++) {
+        if (!trie_write_varint(file, trie_zigzag_encode((long long)node->values[i] - previous))) return 0;
+        previous = node->values[i];
+    }
+
+    // Salva os filhos na ordem dos caracteres
+    if (!trie_write_varint(file, node->child_count)) return 0;
+    for (int i = 0; i < node->child_count; i++) {
+        if (!trie_save_node(file, node->children[i])) {
+            return 0;
         }
     }
 
@@ -336,68 +794,81 @@ int trie_save_to_file(Trie *trie) {
     FILE *file = fopen(trie->filename, "wb");
     if (!file) return 0;
 
-    int success = trie_save_node(file, trie->root);
-    fclose(file);
+    int header[2] = {TRIE_FILE_MAGIC, TRIE_FILE_VERSION};
+    int success = fwrite(header, sizeof(header), 1, file) == 1 &&
+                  trie_save_node(file, trie->root);
+    if (fclose(file) != 0) success = 0;
 
     return success;
 }
 
-// Melhorar carregamento
 TrieNode* trie_load_node(FILE *file) {
-    int node_marker;
-    if (fread(&node_marker, sizeof(int), 1, file) != 1) {
+    unsigned long long edge_length;
+    if (!trie_read_varint(file, &edge_length) || edge_length >= TRIE_MAX_WORD) {
         return NULL;
     }
 
-    if (node_marker == 0) {
-        return NULL; // Nó nulo
+    char edge[TRIE_MAX_WORD];
+    if (edge_length > 0 && fread(edge, 1, edge_length, file) != edge_length) {
+        return NULL;
     }
+    if (!trie_valid_word(edge, (int)edge_length)) return NULL;
 
-    TrieNode *node = trie_create_node();
+    TrieNode *node = edge_length > 0 ? trie_create_edge_node(edge, (int)edge_length)
+                                     : trie_create_node();
     if (!node) return NULL;
 
-    if (fread(&node->is_end_of_word, sizeof(int), 1, file) != 1) {
+    int flag = fgetc(file);
+    unsigned long long value_count;
+    if (flag == EOF || !trie_read_varint(file, &value_count) || value_count > INT_MAX) {
         trie_destroy_node(node);
         return NULL;
     }
+    node->is_end_of_word = flag != 0;
 
-    if (fread(&node->value_count, sizeof(int), 1, file) != 1) {
-        trie_destroy_node(node);
-        return NULL;
-    }
+    // A lista é alocada com o tamanho exato lido do arquivo
+    if (value_count > 0) {
+        node->values = malloc(value_count * sizeof(int));
+        if (!node->values) {
+            trie_destroy_node(node);
+            return NULL;
+        }
+        node->value_capacity = (int)value_count;
 
-    if (node->value_count > 0) {
-        if (node->value_count > node->value_capacity) {
-            long *new_values = realloc(node->values, node->value_count * sizeof(long));
-            if (!new_values) {
+        long long previous = 0;
+        for (; node->value_count < (int)value_count; node->value_count++) {
+            unsigned long long raw;
+            if (!trie_read_varint(file, &raw)) {
                 trie_destroy_node(node);
                 return NULL;
             }
-            node->values = new_values;
-            node->value_capacity = node->value_count;
-        }
-
-        if (fread(node->values, sizeof(long), node->value_count, file) != node->value_count) {
-            trie_destroy_node(node);
-            return NULL;
+            previous += trie_zigzag_decode(raw);
+            // Listas fora de ordem estrita são tratadas como arquivo inválido
+            if (previous < INT_MIN || previous > INT_MAX ||
+                (node->value_count > 0 && previous <= node->values[node->value_count - 1])) {
+                trie_destroy_node(node);
+                return NULL;
+            }
+            node->values[node->value_count] = (int)previous;
         }
     }
 
-    // Carrega bitmap dos filhos
-    unsigned char children_bitmap[ALPHABET_SIZE / 8 + 1];
-    if (fread(children_bitmap, sizeof(children_bitmap), 1, file) != 1) {
+    unsigned long long child_count;
+    if (!trie_read_varint(file, &child_count) || child_count > ALPHABET_SIZE) {
         trie_destroy_node(node);
         return NULL;
     }
 
-    // Carrega apenas os filhos que existem
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
-        if (children_bitmap[i / 8] & (1 << (i % 8))) {
-            node->children[i] = trie_load_node(file);
-            if (!node->children[i]) {
-                trie_destroy_node(node);
-                return NULL;
-            }
+    // Filhos vêm em ordem estrita do primeiro caractere da aresta
+    for (int i = 0; i < (int)child_count; i++) {
+        TrieNode *child = trie_load_node(file);
+        if (!child || child->edge_length == 0 ||
+            (node->child_count > 0 &&
+             node->labels[node->child_count - 1] >= (unsigned char)child->edge[0]) ||
+            !trie_attach_child(node, (unsigned char)child->edge[0], child)) {
+            trie_destroy_node(child);
+            trie_destroy_node(node);
+            return NULL;
         }
     }
 
@@ -408,6 +879,13 @@ Trie* trie_load_from_file(const char *filename) {
     FILE *file = fopen(filename, "rb");
     if (!file) return NULL;
 
+    int header[2];
+    if (fread(header, sizeof(header), 1, file) != 1 ||
+        header[0] != TRIE_FILE_MAGIC || header[1] != TRIE_FILE_VERSION) {
+        fclose(file);
+        return NULL;
+    }
+
     Trie *trie = malloc(sizeof(Trie));
     if (!trie) {
         fclose(file);
@@ -420,7 +898,9 @@ Trie* trie_load_from_file(const char *filename) {
 
     fclose(file);
 
-    if (!trie->root) {
+    // A raiz não tem aresta
+    if (!trie->root || trie->root->edge_length != 0) {
+        trie_destroy_node(trie->root);
         free(trie);
         return NULL;
     }
@@ -428,6 +908,20 @@ Trie* trie_load_from_file(const char *filename) {
     return trie;
 }
 
+// Memória alocada pela subárvore (nós, arestas, vetores de filhos e listas de valores)
+static size_t trie_node_memory(const TrieNode *node) {
+    if (!node) return 0;
+
+    size_t total = sizeof(TrieNode) + node->edge_length +
+                   node->child_capacity * (sizeof(TrieNode*) + 1) +
+                   node->value_capacity * sizeof(int) +
+                   (node->top ? node->top_count * sizeof(TrieNode*) : 0);
+    for (int i = 0; i < node->child_count; i++) {
+        total += trie_node_memory(node->children[i]);
+    }
+    return total;
+}
+
 // Adiciona função para estatísticas da Trie
 void trie_print_statistics(Trie *trie) {
     if (!trie || !trie->root) return;
@@ -444,6 +938,7 @@ void trie_print_statistics(Trie *trie) {
     printf("Total values: %d\n", total_values);
     printf("Average values per word: %.2f\n",
            word_count > 0 ? (double)total_values / word_count : 0);
+    printf("Approximate memory: %zu bytes\n", trie_node_memory(trie->root));
 }
 
 void trie_count_statistics(TrieNode *node, int *node_count, int *word_count, int *total_values) {
@@ -456,9 +951,7 @@ void trie_count_statistics(TrieNode *node, int *node_count, int *word_count, int
         *total_values += node->value_count;
     }
 
-    for (int i = 0; i < ALPHABET_SIZE; i++) {
-        if (node->children[i]) {
-            trie_count_statistics(node->children[i], node_count, word_count, total_values);
-        }
+    for (int i = 0; i < node->child_count; i++) {
+        trie_count_statistics(node->children[i], node_count, word_count, total_values);
     }
 }
@@ -1,6 +1,9 @@
 #ifndef TRIE_H
 #define TRIE_H
 
+// Tamanho máximo do ranking de trie_search_prefix_ranked
+#define TRIE_TOP_K 10
+
 typedef struct Trie Trie;
 
 // Forward declaration para evitar erro de tipo desconhecido
@@ -12,7 +15,32 @@ void trie_destroy(Trie *trie);
 int trie_insert(Trie *trie, const char *word, long value);
 long* trie_search(Trie *trie, const char *word, int *count);
 
+// Visão somente leitura da lista de valores da palavra (em ordem crescente e
+// sem repetições), sem cópia. O ponteiro aponta para a memória da Trie e só é
+// válido até a próxima inserção ou destruição; não deve ser liberado pelo chamador.
+const int* trie_search_view(const Trie *trie, const char *word, int *count);
+
 char** trie_search_prefix(Trie *trie, const char *prefix, int *result_count, int max_results);
+
+// Até max_results palavras com o prefixo (no máximo TRIE_TOP_K), das que têm
+// mais valores para as que têm menos. O ranking de cada nó é calculado uma vez
+// e reaproveitado até a próxima inserção que passe por ele.
+char** trie_search_prefix_ranked(Trie *trie, const char *prefix, int *result_count, int max_results);
+
+// Resultado da busca aproximada
+typedef struct {
+    char *word;                 // Palavra normalizada encontrada
+    int distance;               // Distância de edição até a palavra buscada
+    int value_count;            // Quantidade de valores da palavra
+} TrieFuzzyMatch;
+
+// Palavras a no máximo max_distance edições (inserção, remoção ou troca de um
+// caractere) da buscada, ordenadas pela distância e depois pela quantidade de
+// valores. Liberar com trie_free_fuzzy_matches.
+TrieFuzzyMatch* trie_search_fuzzy(Trie *trie, const char *word, int max_distance,
+                                  int *result_count, int max_results);
+void trie_free_fuzzy_matches(TrieFuzzyMatch *matches, int count);
+
 void trie_print_statistics(Trie *trie);
 
 // Funções de persistência